@@ -0,0 +1,214 @@
+// number to text conversion benchmark by Michael Trikergiotis
+// 16/10/2026
+//
+// Converting numbers to text is something most programs do all the time, when writing logs, 
+// building keys or creating files. This example compares the different ways the mtl provides to
+// convert integers to text with std::to_chars and fmt::format_int. It also shows how to convert
+// numbers to text without any heap allocations by writing them to a buffer or appending them to
+// an existing std::string. Compile with full optimizations turned on to get meaningful timings.
+// 
+// Copyright (c) Michael Trikergiotis. All Rights Reserved.
+// Licensed under the MIT license. See LICENSE in the project root for license information.
+
+
+
+#include <string>                 // std::string
+#include <vector>                 // std::vector
+#include <charconv>               // std::to_chars
+#include <cstdint>                // int64_t
+#include <limits>                 // std::numeric_limits
+#include "../mtl/console.hpp"     // mtl::console::println, mtl::console::print
+#include "../mtl/random.hpp"      // mtl::rng
+#include "../mtl/stopwatch.hpp"   // mtl::chrono::stopwatch
+#include "../mtl/string.hpp"      // mtl::string::to_string, mtl::string::max_number_size_v,
+                                  // mtl::string::pad_back
+#include "../mtl/fmt_include.hpp" // fmt::format_int
+
+
+
+
+// How many times to convert all the numbers for each benchmark.
+constexpr size_t repetitions = 10;
+
+
+
+// Creates random numbers, mostly with many digits but also a few with fewer digits.
+std::vector<int64_t> create_numbers(const size_t count)
+{
+    std::vector<int64_t> numbers;
+    numbers.reserve(count);
+
+    // random numbers using the full range of int64_t
+    mtl::rng<int64_t> big_rng(std::numeric_limits<int64_t>::min(), 
+                              std::numeric_limits<int64_t>::max());
+    // random numbers with only a few digits
+    mtl::rng<int64_t> small_rng(-99999, 99999);
+
+    for(size_t i = 0; i < count; ++i)
+    {
+        if(i % 2 == 0)
+        {
+            numbers.push_back(big_rng.next());
+        }
+        else
+        {
+            numbers.push_back(small_rng.next());
+        }
+    }
+
+    return numbers;
+}
+
+
+
+// Prints how long a benchmark took.
+void print_result(const std::string& name, mtl::chrono::stopwatch& sw, const size_t count)
+{
+    const double time_taken_ms = sw.elapsed_milli();
+    // how many nanoseconds each conversion took
+    const double ns_per_number = (time_taken_ms * 1'000'000.0) / static_cast<double>(count);
+
+    std::string padded_name = name;
+    mtl::string::pad_back(padded_name, 45 - name.size(), '.');
+    mtl::console::print(padded_name, " ", time_taken_ms, " ms, ", ns_per_number, 
+                        " ns per number\n");
+}
+
+
+
+// Checks that all methods produce exactly the same characters for every number.
+bool same_results(const std::vector<int64_t>& numbers)
+{
+    // a buffer large enough for any int64_t, mtl::string::max_number_size_v gives the maximum
+    // number of characters any number of a given type can need
+    char buffer[mtl::string::max_number_size_v<int64_t>];
+    char to_chars_buffer[mtl::string::max_number_size_v<int64_t>];
+
+    for(const auto number : numbers)
+    {
+        const std::string mtl_text(buffer, mtl::string::to_string(number, buffer));
+        const std::string to_chars_text(to_chars_buffer, std::to_chars(to_chars_buffer, 
+                                        to_chars_buffer + sizeof(to_chars_buffer), number).ptr);
+        const fmt::format_int fmt_text(number);
+        std::string append_text = "number ";
+        mtl::string::to_string(number, append_text);
+
+        if((mtl_text != to_chars_text) || (mtl_text != fmt_text.str()) || 
+           (mtl_text != mtl::string::to_string(number)) || (append_text != "number " + mtl_text))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+
+// Converts all numbers to text using the different methods and prints how long each one took.
+void benchmark(const std::vector<int64_t>& numbers)
+{
+    const size_t count = numbers.size() * repetitions;
+    mtl::chrono::stopwatch sw;
+
+    char buffer[mtl::string::max_number_size_v<int64_t>];
+
+    // keeps count of the characters created so the compiler can't skip the conversions
+    size_t total_size = 0;
+
+    sw.start();
+    for(size_t rep = 0; rep < repetitions; ++rep)
+    {
+        for(const auto number : numbers)
+        {
+            // writes the number to the buffer without any allocations and returns the position
+            // after the last character
+            const char* last = mtl::string::to_string(number, buffer);
+            total_size += static_cast<size_t>(last - buffer);
+        }
+    }
+    sw.stop();
+    print_result("mtl::string::to_string to a buffer", sw, count);
+
+
+    sw.start();
+    for(size_t rep = 0; rep < repetitions; ++rep)
+    {
+        for(const auto number : numbers)
+        {
+            const char* last = std::to_chars(buffer, buffer + sizeof(buffer), number).ptr;
+            total_size += static_cast<size_t>(last - buffer);
+        }
+    }
+    sw.stop();
+    print_result("std::to_chars to a buffer", sw, count);
+
+
+    sw.start();
+    for(size_t rep = 0; rep < repetitions; ++rep)
+    {
+        for(const auto number : numbers)
+        {
+            const fmt::format_int formatted(number);
+            total_size += formatted.size();
+        }
+    }
+    sw.stop();
+    print_result("fmt::format_int", sw, count);
+
+
+    sw.start();
+    for(size_t rep = 0; rep < repetitions; ++rep)
+    {
+        for(const auto number : numbers)
+        {
+            // creates a new std::string for every number, which may allocate
+            const std::string text = mtl::string::to_string(number);
+            total_size += text.size();
+        }
+    }
+    sw.stop();
+    print_result("mtl::string::to_string returning a string", sw, count);
+
+
+    // reuse the same std::string so after the first numbers it never has to allocate again
+    std::string text;
+    sw.start();
+    for(size_t rep = 0; rep < repetitions; ++rep)
+    {
+        text.clear();
+        for(const auto number : numbers)
+        {
+            // appends the number to the end of the std::string
+            mtl::string::to_string(number, text);
+        }
+        total_size += text.size();
+    }
+    sw.stop();
+    print_result("mtl::string::to_string appending a string", sw, count);
+
+    mtl::console::print("\nCreated ", total_size, " characters in total.\n");
+}
+
+
+
+int main()
+{
+    mtl::console::println("------------------------------------------");
+    mtl::console::println("[BENCHMARK - CONVERTING INTEGERS TO TEXT]");
+    mtl::console::println("------------------------------------------");
+
+    const auto numbers = create_numbers(1'000'000);
+    mtl::console::print("Converting ", numbers.size(), " random numbers ", repetitions, 
+                        " times with each method.\n\n");
+    benchmark(numbers);
+
+    // check that all methods produced exactly the same characters
+    if(same_results(numbers))
+    {
+        mtl::console::println("All methods produced the same results.");
+    }
+    else
+    {
+        mtl::console::println("Error. The methods produced different results!!!");
+    }
+}
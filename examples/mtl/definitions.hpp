@@ -35,3 +35,30 @@
 #endif // _WIN32 end
 
 // ================================================================================================
+
+
+
+// This detects if we can use x86 SIMD intrinsics. SSE2 is always available on x86-64 and is
+// required to be enabled when compiling for 32 bit x86. AVX2 is detected during runtime. Define
+// MTL_DISABLE_SIMD before including any mtl header to only use the portable scalar algorithms.
+
+#if !defined(MTL_DISABLE_SIMD)
+
+#if defined(__x86_64__) || defined(_M_X64) || \
+	((defined(__i386__) || defined(_M_IX86)) && (defined(__SSE2__) || (_M_IX86_FP >= 2)))
+#define MTL_SIMD_X86
+#endif // __x86_64__, _M_X64, __i386__, _M_IX86 end
+
+#endif // MTL_DISABLE_SIMD end
+
+
+// GCC and clang only allow AVX2 intrinsics in functions that are marked as AVX2 functions, while
+// MSVC allows them everywhere.
+
+#if defined(__GNUC__) || defined(__clang__)
+#define MTL_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define MTL_TARGET_AVX2
+#endif // __GNUC__ and __clang__ end
+
+// ================================================================================================
@@ -16,14 +16,89 @@
 						   // std::filesystem::is_regular_file
 #include <string>          // std::string
 #include <string_view>     // std::string_view
-#include <cstdint>         // std::uintmax_t
+#include <cstdint>         // std::uintmax_t, std::uint64_t, std::int64_t, std::uint32_t,
+						   // std::uint8_t
 #include <fstream>		   // std::ofstream, std::ifstream
-#include <system_error>    // std::error_code
+#include <system_error>    // std::error_code, std::system_error
 #include <limits>          // std::numeric_limits
 #include <ios>			   // std::ios_base::openmode, std::ios::out, 
-						   // std::ios::binary, std::streamsize
-#include "string.hpp"      // mtl::string::join_all
-#include "utility.hpp"     // MTL_ASSERT_MSG
+						   // std::ios::binary, std::streamsize, std::streamoff
+#include <utility>         // std::swap, std::exchange, std::move
+#include <vector>          // std::vector
+#include <memory>          // std::unique_ptr, std::make_unique
+#include <cstring>         // std::memchr, std::memmove, std::memcpy
+#include <iterator>        // std::input_iterator_tag, std::iterator_traits, std::next,
+						   // std::random_access_iterator_tag, std::distance,
+						   // std::back_inserter
+#include <array>           // std::array
+#include <type_traits>     // std::is_same_v, std::remove_cv_t, std::is_base_of_v
+#include <cstddef>         // std::ptrdiff_t
+#include <algorithm>       // std::max, std::min, std::find
+#include <thread>          // std::thread, std::this_thread::sleep_for
+#include <mutex>           // std::mutex, std::unique_lock, std::lock_guard
+#include <condition_variable> // std::condition_variable
+#include <atomic>          // std::atomic
+#include <chrono>          // std::chrono::milliseconds, std::chrono::steady_clock
+#include <exception>       // std::exception_ptr, std::current_exception, std::rethrow_exception
+#include <stdexcept>       // std::out_of_range
+#include <initializer_list> // std::initializer_list
+#include "container.hpp"   // mtl::emplace_back, mtl::reserve
+#include "string.hpp"      // mtl::string::join_all, mtl::string::join,
+						   // mtl::string::detail::cpu_has_avx2,
+						   // mtl::string::detail::find_first_of_two
+#include "utility.hpp"     // MTL_ASSERT_MSG, mtl::no_copy, mtl::no_move
+#include "stopwatch.hpp"   // mtl::chrono::stopwatch
+
+#if defined(MTL_SIMD_X86)
+#include <immintrin.h> // __m128i, __m256i, _mm_loadu_si128, _mm_mul_epu32, _mm256_mul_epu32
+#endif // MTL_SIMD_X86 end
+
+#if defined(_MSC_VER)
+#include <intrin.h>    // _umul128
+#endif // _MSC_VER end
+
+
+// Windows only headers
+#if defined(_WIN32)
+
+// this define makes the huge Windows.h header compile faster
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif // WIN32_LEAN_AND_MEAN
+
+#if defined(__MINGW32__) || defined(__MINGW64__)
+// we need to include the lowercase windows.h header because it fixes a cross-compilation issue
+// when compiling with mingw on Linux targeting Windows
+#include <windows.h>
+#else
+// use the Windows.h header like normal
+#include <Windows.h> // HANDLE, CreateFileW, CreateFileMappingW, MapViewOfFile, UnmapViewOfFile,
+					 // CloseHandle, GetFileSizeEx, WriteFile, FlushFileBuffers, MoveFileExW,
+					 // GetCurrentProcessId
+#endif // __MINGW32__ and __MINGW64__ end
+
+
+// Linux / Unix only headers
+#else
+
+#include <fcntl.h>    // open, posix_fallocate, O_RDONLY, O_WRONLY, O_CREAT, O_TRUNC, O_APPEND,
+					  // O_CLOEXEC
+#include <unistd.h>   // close, ftruncate, lseek, sysconf, fsync, getpid, pread, read, fchown,
+					  // geteuid, getegid
+#include <sys/mman.h> // mmap, munmap, madvise
+#include <sys/stat.h> // fstat, fstatat, statx, stat, fchmod
+#include <dirent.h>   // fdopendir, readdir, closedir
+#include <sys/uio.h>  // writev, iovec
+#include <cerrno>     // errno, EINTR
+#include <cstdio>     // rename
+
+#if defined(__linux__)
+#include <sys/inotify.h> // inotify_init1, inotify_add_watch, IN_MODIFY, IN_CREATE, IN_MOVED_TO
+#include <poll.h>        // poll, pollfd, POLLIN
+#include <sys/syscall.h> // SYS_getdents64
+#endif // __linux__ end
+
+#endif // _WIN32 end
 
 
 
@@ -39,8 +114,108 @@ namespace filesystem
 // ================================================================================================
 
 
+namespace detail
+{
+	// Reads files directly with the operating system functions without any buffering. On Linux and
+	// Unix it reads with pread on a raw file descriptor and on Windows with ReadFile. The file is
+	// closed when the object is destroyed.
+	class raw_file_reader : mtl::no_move
+	{
+#if defined(_WIN32)
+		HANDLE _handle = INVALID_HANDLE_VALUE;
+#else
+		int _fd = -1;
+#endif // _WIN32 end
+
+	public:
+
+		raw_file_reader() = default;
+
+		~raw_file_reader()
+		{
+#if defined(_WIN32)
+			if (_handle != INVALID_HANDLE_VALUE) { CloseHandle(_handle); }
+#else
+			if (_fd != -1) { ::close(_fd); }
+#endif // _WIN32 end
+		}
+
+		// Opens the file and gets its size. Returns if it was successful.
+		bool open(const std::filesystem::path& filename, std::uintmax_t& size)
+		{
+#if defined(_WIN32)
+			_handle = CreateFileW(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, 
+								  OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			if (_handle == INVALID_HANDLE_VALUE) { return false; }
+			LARGE_INTEGER file_size {};
+			if (GetFileSizeEx(_handle, &file_size) == 0) { return false; } // GCOVR_EXCL_LINE
+			size = static_cast<std::uintmax_t>(file_size.QuadPart);
+#else
+			_fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+			if (_fd == -1) { return false; }
+			struct stat file_stat {};
+			if (::fstat(_fd, &file_stat) != 0) { return false; } // GCOVR_EXCL_LINE
+			// directories can be opened but not read
+			if (S_ISDIR(file_stat.st_mode)) { return false; }
+			size = static_cast<std::uintmax_t>(file_stat.st_size);
+#endif // _WIN32 end
+			return true;
+		}
+
+		// Reads up to size bytes from the start of the file. The count is the number of bytes
+		// read which is less than the size if the file became smaller after it was opened.
+		// Returns if it was successful.
+		bool read(char* destination, const size_t size, size_t& count)
+		{
+			count = 0;
+			while (count < size)
+			{
+#if defined(_WIN32)
+				const auto chunk = static_cast<DWORD>(
+					std::min<size_t>(size - count, std::numeric_limits<DWORD>::max()));
+				DWORD bytes_read = 0;
+				if (ReadFile(_handle, destination + count, chunk, &bytes_read, nullptr) == 0)
+				{
+					return false; // GCOVR_EXCL_LINE
+				}
+				if (bytes_read == 0) { return true; }
+				count += bytes_read;
+#else
+				const size_t chunk = std::min<size_t>(size - count, 
+									 static_cast<size_t>(std::numeric_limits<ssize_t>::max()));
+				const ssize_t bytes_read = ::pread(_fd, destination + count, chunk, 
+												   static_cast<off_t>(count));
+				if (bytes_read < 0)
+				{
+					if (errno == EINTR) { continue; } // GCOVR_EXCL_LINE
+					return false; // GCOVR_EXCL_LINE
+				}
+				if (bytes_read == 0) { return true; }
+				count += static_cast<size_t>(bytes_read);
+#endif // _WIN32 end
+			}
+			return true;
+		}
+	};
+
+	// Checks the size of a file fits in a size_t. Files larger than what size_t can hold can't
+	// be read when compiling in 32 bit mode.
+	[[nodiscard]]
+	inline bool file_size_fits(const std::uintmax_t size) noexcept
+	{
+		// thow an assert in debug mode to alert the user
+		MTL_ASSERT_MSG((size <= std::numeric_limits<size_t>::max()),
+		"Error in mtl::filesystem::read_file. File too large for 32 bit operating system.");
+		return (size <= std::numeric_limits<size_t>::max());
+	}
+
+} // namespace detail end
+
+
 /// Read an entire file to an std::string. The filename is used to specify which file to read.
-/// The read_data is where the read file will be stored. Returns if the file was read successfully.
+/// The read_data is where the read file will be stored. The memory the std::string already has
+/// is reused so reading many files to the same std::string allocates only when a file is larger
+/// than all the previous ones. Returns if the file was read successfully.
 /// @param[in] filename The relative or absolute path to a file.
 /// @param[out] read_data An std::string where the read file will be stored.
 /// @return Returns if the file was read successfully.
@@ -53,59 +228,412 @@ inline bool read_file(const std::filesystem::path& filename, std::string& read_d
 				   "File doesn't exist or incorrect path given.");
 #endif // MTL_DISABLE_SOME_ASSERTS end
 
-	// what mode to open the file
-	std::ios_base::openmode open_mode = std::ios::out;
-	// set the mask to binary mode so it works better in Windows when reading newlines
-	open_mode = (open_mode | std::ios::binary);
+	// read directly from the operating system instead of using std::ifstream that has its own 
+	// buffer and copies everything one more time
+	mtl::filesystem::detail::raw_file_reader reader;
+	std::uintmax_t size = 0;
+	if (reader.open(filename, size) == false) { return false; }
+	if (mtl::filesystem::detail::file_size_fits(size) == false) { return false; }
 
-	// std::ifstream is RAII wrapper and will close correctly if an exception is thrown
-	std::ifstream in_file(filename, open_mode);
+	bool success = true;
+#if defined(__cpp_lib_string_resize_and_overwrite)
+	// grow the std::string without filling it with zeros first
+	// the size given to the function may be the new capacity with some standard libraries so
+	// read only as much as the size of the file
+	read_data.resize_and_overwrite(static_cast<size_t>(size), [&](char* data, size_t)
+	{
+		size_t count = 0;
+		success = reader.read(data, static_cast<size_t>(size), count);
+		return count;
+	});
+#else
+	// resize the output to be exactly the same size as the file, resizing never allocates when
+	// the std::string already has enough capacity
+	read_data.resize(static_cast<size_t>(size));
+	size_t count = 0;
+	success = reader.read(read_data.data(), read_data.size(), count);
+	// the file may have become smaller after we got its size
+	read_data.resize(count);
+#endif // __cpp_lib_string_resize_and_overwrite end
 
-	// if we can't open the file it is an error
-	if (in_file.is_open() == false) { return false; }
+	return success;
+}
 
-	// enable exceptions for std::ifstream, do not use std::ifstream::failbit as it is set when
-	// EOF is reached and it throws an exception even when there is no actual error
-	in_file.exceptions(std::ifstream::badbit);
 
-	// create an std::error_code object so we can call the noexcept version
-	std::error_code error_code;
-	// get exact file size in bytes
-	std::uintmax_t size = std::filesystem::file_size(filename, error_code);
-	// if filesize is 0 then just leave and report success as there is nothing to be read
-	if (size == 0) { return true; }
-	// if the std::error_code indicates an error or the size from std::filesystem::file_size 
-	// is equal static_cast<std::uintmax_t>(-1) then we have an error
-	auto too_big = static_cast<std::uintmax_t>(-1);
-	if ((error_code) || (size == too_big)) { return false; } // GCOVR_EXCL_LINE
-
-	// check if we are compiling in 64 bit mode, for gcc and clang we detect 64 bit compilation
-	// with the macro __LP64__ and for MSVC with the macro _WIN64
-#if defined(__LP64__) || defined(_WIN64)
-	// resize the output to be exactly the same size as the file
-	read_data.resize(size);
-#else
-	// when compiling in 32 bit mode size_t it is way smaller than std::uintmax_t so we have to
-	// check and not allow file to be read if is beyond what size_t can hold as we can't resize
-	// the output beyond size_t for an std::string, this usually will not happen as 32 bit OS
-	// can't use files beyond 4GB but better be safe than sorry
 
-	// thow an assert in debug mode to alert the user
-	MTL_ASSERT_MSG((size <= std::numeric_limits<size_t>::max()),
-	"Error in mtl::filesystem::read_file. File too large for 32 bit operating system.");
+// ================================================================================================
+// READ_BUFFER      - A growable buffer that can be reused to read many files.
+// ================================================================================================
+
+
+/// A growable buffer of characters made for reading many files one after the other. Unlike an
+/// std::string growing it doesn't fill the new memory with zeros and it never gives memory back
+/// until it is destroyed, so after it has grown to the size of the largest file reading more files
+/// doesn't allocate at all. Can be moved but not copied.
+class read_buffer : mtl::no_copy
+{
+	// The memory of the buffer.
+	std::unique_ptr<char[]> _data;
+	// The number of characters used.
+	size_t _size = 0;
+	// The number of characters the memory can hold.
+	size_t _capacity = 0;
+
+public:
+
+	/// Default constructor that creates an empty buffer without allocating memory.
+	read_buffer() = default;
+
+	/// Constructor that creates an empty buffer that can hold the given number of characters.
+	/// @param[in] capacity The number of characters the buffer can hold without allocating.
+	explicit read_buffer(const size_t capacity) { reserve(capacity); }
+
+	/// Makes sure the buffer can hold at least the given number of characters without allocating.
+	/// The characters already in the buffer are kept.
+	/// @param[in] capacity The number of characters the buffer can hold without allocating.
+	void reserve(const size_t capacity)
+	{
+		if (capacity <= _capacity) { return; }
+		// new without () leaves the characters uninitialized
+		std::unique_ptr<char[]> new_data(new char[capacity]);
+		if (_size > 0) { std::memcpy(new_data.get(), _data.get(), _size); }
+		_data = std::move(new_data);
+		_capacity = capacity;
+	}
+
+	/// Changes the number of characters used. When the size grows the new characters are not
+	/// initialized. The memory grows by at least half of its capacity each time it has to grow.
+	/// @param[in] size The number of characters used.
+	void resize(const size_t size)
+	{
+		if (size > _capacity) { reserve(std::max(size, _capacity + (_capacity / 2))); }
+		_size = size;
+	}
+
+	/// Removes all the characters but keeps the memory.
+	void clear() noexcept { _size = 0; }
+
+	/// Returns a pointer to the characters of the buffer.
+	/// @return A pointer to the characters.
+	[[nodiscard]]
+	char* data() noexcept { return _data.get(); }
+
+	/// Returns a pointer to the characters of the buffer.
+	/// @return A pointer to the characters.
+	[[nodiscard]]
+	const char* data() const noexcept { return _data.get(); }
+
+	/// Returns the number of characters used.
+	/// @return The number of characters used.
+	[[nodiscard]]
+	size_t size() const noexcept { return _size; }
+
+	/// Returns the number of characters the buffer can hold without allocating.
+	/// @return The number of characters the buffer can hold.
+	[[nodiscard]]
+	size_t capacity() const noexcept { return _capacity; }
+
+	/// Returns if the buffer has no characters.
+	/// @return If the buffer has no characters.
+	[[nodiscard]]
+	bool empty() const noexcept { return (_size == 0); }
+
+	/// Returns an std::string_view of the characters of the buffer.
+	/// @return An std::string_view of the characters.
+	[[nodiscard]]
+	std::string_view view() const noexcept { return std::string_view(_data.get(), _size); }
+};
+
+
+/// Read an entire file to an mtl::filesystem::read_buffer. The memory of the buffer is reused and
+/// it only grows when the file is larger than its capacity, so reading many files with the same
+/// buffer doesn't allocate after it has grown to the size of the largest file. The file is read
+/// directly with pread on Linux and Unix and with ReadFile on Windows. Returns if the file was
+/// read successfully.
+/// @param[in] filename The relative or absolute path to a file.
+/// @param[out] read_data An mtl::filesystem::read_buffer where the read file will be stored.
+/// @return Returns if the file was read successfully.
+inline bool read_file(const std::filesystem::path& filename, read_buffer& read_data)
+{
+
+#ifndef MTL_DISABLE_SOME_ASSERTS
+	// when in debug mode check the file we want to open exists and assert if it doesn't
+	MTL_ASSERT_MSG(std::filesystem::is_regular_file(filename),
+				   "File doesn't exist or incorrect path given.");
+#endif // MTL_DISABLE_SOME_ASSERTS end
+
+	read_data.clear();
 
-	// return false to indicate that the file was not read because of size
-	if (size > std::numeric_limits<size_t>::max()) { return false; }
+	mtl::filesystem::detail::raw_file_reader reader;
+	std::uintmax_t size = 0;
+	if (reader.open(filename, size) == false) { return false; }
+	if (mtl::filesystem::detail::file_size_fits(size) == false) { return false; }
 
-	// resize the output to be exactly the same size as the file
 	read_data.resize(static_cast<size_t>(size));
-#endif // __LP64__ end
+	size_t count = 0;
+	const bool success = reader.read(read_data.data(), read_data.size(), count);
+	// the file may have become smaller after we got its size
+	read_data.resize(count);
+	return success;
+}
 
-	// read the file and place it in the output
-	in_file.read(read_data.data(), static_cast<std::streamsize>(size));
 
-	// if we reached this point it means success
-	return true;
+
+// ================================================================================================
+// MAPPED_FILE      - Read-only memory-mapped view of an entire file.
+// ================================================================================================
+
+
+/// Read-only memory-mapped view of an entire file. The contents of the file are accessed directly
+/// from the operating system's page cache without being copied to the heap. The view stays valid
+/// for as long as the mtl::filesystem::mapped_file is open. Can be moved but not copied.
+class mapped_file : mtl::no_copy
+{
+	// Pointer to the start of the mapped region.
+	const char* _data = nullptr;
+	// Size of the mapped region in bytes.
+	size_t _size = 0;
+	// If a file is currently open.
+	bool _open = false;
+
+#if defined(_WIN32)
+	// Handle to the file mapping object.
+	HANDLE _mapping = nullptr;
+#endif // _WIN32 end
+
+	// Swaps all members with another mapped_file.
+	void swap(mapped_file& other) noexcept
+	{
+		std::swap(_data, other._data);
+		std::swap(_size, other._size);
+		std::swap(_open, other._open);
+#if defined(_WIN32)
+		std::swap(_mapping, other._mapping);
+#endif // _WIN32 end
+	}
+
+public:
+
+	// ============================================================================================
+	// MAPPED_FILE - Constructors, destructor and move operations.
+	// ============================================================================================
+
+	/// Default constructor that doesn't open any file.
+	mapped_file() = default;
+
+	/// Constructor that opens and maps a file. Use is_open to check if it was successful.
+	/// @param[in] filename The relative or absolute path to a file.
+	explicit mapped_file(const std::filesystem::path& filename) { open(filename); }
+
+	/// Destructor that unmaps the file.
+	~mapped_file() { close(); }
+
+	/// Move constructor.
+	mapped_file(mapped_file&& other) noexcept { swap(other); }
+
+	/// Move assignment operator.
+	mapped_file& operator=(mapped_file&& other) noexcept
+	{
+		if (this != &other)
+		{
+			close();
+			swap(other);
+		}
+		return *this;
+	}
+
+	// ============================================================================================
+	// OPEN - Opens and maps a file.
+	// ============================================================================================
+
+	/// Opens and maps a file to memory for reading. If another file was already open it is closed
+	/// first. Hints the operating system that the file will be read sequentially and soon. 
+	/// Returns if the file was mapped successfully.
+	/// @param[in] filename The relative or absolute path to a file.
+	/// @return Returns if the file was mapped successfully.
+	bool open(const std::filesystem::path& filename)
+	{
+		close();
+
+#if defined(_WIN32)
+
+		HANDLE file = CreateFileW(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+								  OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE) { return false; }
+
+		LARGE_INTEGER file_size {};
+		if (GetFileSizeEx(file, &file_size) == 0)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		const auto size = static_cast<std::uint64_t>(file_size.QuadPart);
+		
+		// Windows can't map empty files, but an empty file is still a successfully opened file
+		if (size == 0)
+		{
+			CloseHandle(file);
+			_open = true;
+			return true;
+		}
+
+		// files larger than what size_t can hold can't be mapped when compiling in 32 bit mode
+		if (size > std::numeric_limits<size_t>::max())
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		// the mapping keeps a reference to the file so we no longer need the file handle
+		CloseHandle(file);
+		if (_mapping == nullptr) { return false; }
+
+		void* address = MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+		if (address == nullptr)
+		{
+			CloseHandle(_mapping);
+			_mapping = nullptr;
+			return false;
+		}
+
+		_data = static_cast<const char*>(address);
+		_size = static_cast<size_t>(size);
+		_open = true;
+		return true;
+
+#else
+
+		const int fd = ::open(filename.c_str(), O_RDONLY);
+		if (fd == -1) { return false; }
+
+		struct stat file_stat {};
+		if (::fstat(fd, &file_stat) != 0)
+		{
+			::close(fd);
+			return false;
+		}
+
+		const auto size = static_cast<std::uintmax_t>(file_stat.st_size);
+
+		// mmap doesn't accept a size of 0, but an empty file is still a successfully opened file
+		if (size == 0)
+		{
+			::close(fd);
+			_open = true;
+			return true;
+		}
+
+		// files larger than what size_t can hold can't be mapped when compiling in 32 bit mode
+		if (size > std::numeric_limits<size_t>::max())
+		{
+			::close(fd);
+			return false;
+		}
+
+		void* address = ::mmap(nullptr, static_cast<size_t>(size), PROT_READ, MAP_PRIVATE, fd, 0);
+		// the mapping keeps a reference to the file so we no longer need the file descriptor
+		::close(fd);
+		if (address == MAP_FAILED) { return false; }
+
+		// hint the kernel to read ahead aggressively and to start reading immediately, hints are
+		// only advisory so failure is not an error
+		::madvise(address, static_cast<size_t>(size), MADV_SEQUENTIAL);
+		::madvise(address, static_cast<size_t>(size), MADV_WILLNEED);
+
+		_data = static_cast<const char*>(address);
+		_size = static_cast<size_t>(size);
+		_open = true;
+		return true;
+
+#endif // _WIN32 end
+	}
+
+	// ============================================================================================
+	// CLOSE - Unmaps the file.
+	// ============================================================================================
+
+	/// Unmaps the file. Any std::string_view previously returned becomes invalid.
+	void close() noexcept
+	{
+#if defined(_WIN32)
+		if (_data != nullptr) { UnmapViewOfFile(_data); }
+		if (_mapping != nullptr) { CloseHandle(_mapping); }
+		_mapping = nullptr;
+#else
+		if (_data != nullptr) { ::munmap(const_cast<char*>(_data), _size); }
+#endif // _WIN32 end
+		_data = nullptr;
+		_size = 0;
+		_open = false;
+	}
+
+	// ============================================================================================
+	// IS_OPEN - Returns if a file is open.
+	// ============================================================================================
+
+	/// Returns if a file is open.
+	/// @return If a file is open.
+	[[nodiscard]]
+	bool is_open() const noexcept { return _open; }
+
+	// ============================================================================================
+	// VIEW - Returns the contents of the file.
+	// ============================================================================================
+
+	/// Returns the contents of the file as an std::string_view.
+	/// @return An std::string_view over the entire file.
+	[[nodiscard]]
+	std::string_view view() const noexcept { return std::string_view(_data, _size); }
+
+	// ============================================================================================
+	// DATA - Returns a pointer to the contents of the file.
+	// ============================================================================================
+
+	/// Returns a pointer to the contents of the file. Returns nullptr for empty files.
+	/// @return A pointer to the start of the file.
+	[[nodiscard]]
+	const char* data() const noexcept { return _data; }
+
+	// ============================================================================================
+	// SIZE - Returns the size of the file.
+	// ============================================================================================
+
+	/// Returns the size of the file in bytes.
+	/// @return The size of the file.
+	[[nodiscard]]
+	size_t size() const noexcept { return _size; }
+
+	// ============================================================================================
+	// EMPTY - Returns if the file is empty.
+	// ============================================================================================
+
+	/// Returns if the file is empty.
+	/// @return If the file is empty.
+	[[nodiscard]]
+	bool empty() const noexcept { return (_size == 0); }
+};
+
+
+/// Read an entire file by memory-mapping it instead of copying it to the heap. The filename is
+/// used to specify which file to read. The read_data is where the mapped file will be stored and
+/// its contents can be accessed with mtl::filesystem::mapped_file::view. Returns if the file was
+/// read successfully.
+/// @param[in] filename The relative or absolute path to a file.
+/// @param[out] read_data An mtl::filesystem::mapped_file where the read file will be stored.
+/// @return Returns if the file was read successfully.
+inline bool read_file(const std::filesystem::path& filename,
+					  mtl::filesystem::mapped_file& read_data)
+{
+
+#ifndef MTL_DISABLE_SOME_ASSERTS
+	// when in debug mode check the file we want to open exists and assert if it doesn't
+	MTL_ASSERT_MSG(std::filesystem::is_regular_file(filename),
+				   "File doesn't exist or incorrect path given.");
+#endif // MTL_DISABLE_SOME_ASSERTS end
+
+	return read_data.open(filename);
 }
 
 
@@ -119,15 +647,16 @@ namespace detail
 {
 	// Splits the given string at newlines and stores them to the given container. Specialized
 	// string splitting algorithm that takes into account both LF and CRLF characters when
-	// splitting at newlines.
+	// splitting at newlines. The container element type can be std::string or std::string_view,
+	// in the case of std::string_view the tokens point inside the read_data.
 	template<typename Container>
-	inline void specialized_split_crlf(const std::string& read_data, Container& split_lines)
+	inline void specialized_split_crlf(std::string_view read_data, Container& split_lines)
 	{	
 		// handle the case where there is only one character and it is a newline
 		if((read_data.size() == 1) && (read_data[0] == '\n'))
 		{
-			mtl::emplace_back(split_lines, std::string("")); 
-			mtl::emplace_back(split_lines, std::string("")); 
+			mtl::emplace_back(split_lines, std::string_view()); 
+			mtl::emplace_back(split_lines, std::string_view()); 
 			return;
 		}
 
@@ -138,69 +667,124 @@ namespace detail
 			return;
 		}
 
-		// the size of the container before we start modifying it
-		const auto original_size = split_lines.size();
-
-		const std::string delimiter ("\n");
-
 		// remember the starting position
 		size_t start = 0;
-		// position of the first match
-		size_t match_pos = read_data.find(delimiter);
 
-		// keep the position for the last item
-		size_t last_pos = 0;
+		// find every newline in a single pass and add all tokens to the container except the
+		// last one
+		mtl::string::detail::find_all_chars(read_data, '\n', [&](const size_t match_pos)
+		{
+			size_t token_end = match_pos;
+			// crlf case, the carriage return before the newline is not part of the token
+			if ((match_pos > start) && (read_data[match_pos - 1] == '\r')) { --token_end; }
+			
+			const std::string_view token(read_data.data() + start, token_end - start);
+			mtl::emplace_back(split_lines, token);
+
+			// set the new starting position
+			start = match_pos + 1;
+		});
+
+		// add the last item using the last position, if there were no newlines at all this adds
+		// the entire input string because it means there are no places that it needs to be split
+		const std::string_view token(read_data.data() + start, read_data.size() - start);
+		mtl::emplace_back(split_lines, token);
+	}
+
+	// Splits the given string at newlines using multiple threads and stores them to the given
+	// container. The input is divided in chunks that always end right after a newline, each chunk
+	// is split on its own thread with mtl::filesystem::detail::specialized_split_crlf and then all
+	// the results are added to the container in order. The output is identical to calling
+	// mtl::filesystem::detail::specialized_split_crlf. A thread_count of 0 uses as many threads as
+	// the hardware supports.
+	template<typename Container>
+	inline void parallel_split_crlf(std::string_view read_data, Container& split_lines,
+									size_t thread_count = 0)
+	{
+		// the smallest amount of bytes worth giving to a thread
+		constexpr size_t min_chunk_size = 1024 * 1024;
+
+		if (thread_count == 0) { thread_count = std::thread::hardware_concurrency(); }
+		const size_t max_threads = read_data.size() / min_chunk_size;
+		if (thread_count > max_threads) { thread_count = max_threads; }
+
+		// when the input is too small it is faster to not use threads at all
+		if (thread_count < 2)
+		{
+			mtl::filesystem::detail::specialized_split_crlf(read_data, split_lines);
+			return;
+		}
+
+		// find where each chunk ends, each chunk has to end right after a newline so no line and
+		// no CRLF pair is divided between two chunks
+		std::vector<size_t> boundaries { 0 };
+		const size_t approximate_size = read_data.size() / thread_count;
+		for (size_t i = 1; i < thread_count; ++i)
+		{
+			const size_t from = std::max(i * approximate_size, boundaries.back());
+			const size_t match_pos = read_data.find('\n', from);
+			if (match_pos == std::string_view::npos) { break; }
+			if (match_pos + 1 < read_data.size()) { boundaries.push_back(match_pos + 1); }
+		}
+		boundaries.push_back(read_data.size());
 
-		// add all tokens to the container except the last one
-		while (match_pos != std::string::npos)
+		const size_t chunk_count = boundaries.size() - 1;
+		using element_type = typename Container::value_type;
+		std::vector<std::vector<element_type>> chunk_lines(chunk_count);
+		std::vector<std::exception_ptr> errors(chunk_count);
+		const auto split_chunk = [&](const size_t i)
 		{
-			last_pos = match_pos;	
-			// make sure match position is larger than 0
-			if(match_pos > 0)
+			try
 			{
-				// lf case
-				if(read_data[match_pos - 1] != '\r')
-				{
-					const std::string_view token(read_data.data() + start, match_pos - start);
-					mtl::emplace_back(split_lines, token);
-				}
-				// crlf case
-				else
-				{
-					const auto crlf_position = match_pos - (start + 1);
-					const std::string_view token(read_data.data() + start, crlf_position);
-					mtl::emplace_back(split_lines, token);
-				}
+				const auto chunk = read_data.substr(boundaries[i], 
+													boundaries[i + 1] - boundaries[i]);
+				mtl::filesystem::detail::specialized_split_crlf(chunk, chunk_lines[i]);
+				// every chunk except the last ends with a newline so the empty token after it
+				// belongs to the start of the next chunk
+				if (i + 1 < chunk_count) { chunk_lines[i].pop_back(); }
 			}
-			else
+			catch (...)
 			{
-				const std::string_view token(read_data.data() + start, match_pos - start);
-				mtl::emplace_back(split_lines, token);
-			}	
-			
-			// set the new starting position
-			start = match_pos + 1;
-			// find a new position in the input string if there are any matches left
-			match_pos = read_data.find(delimiter, start);
+				errors[i] = std::current_exception();
+			}
+		};
+
+		std::vector<std::thread> threads;
+		threads.reserve(chunk_count);
+		for (size_t i = 0; i < chunk_count; ++i)
+		{
+			// if the thread can't be started the chunk is split by the calling thread
+			try
+			{
+				threads.emplace_back(split_chunk, i);
+			}
+			// GCOVR_EXCL_START
+			catch (const std::system_error&)
+			{
+				split_chunk(i);
+			}
+			// GCOVR_EXCL_STOP
 		}
 
-		// how much we added to the container
-		const auto size_difference = split_lines.size() - original_size;
+		for (auto& thread : threads) { thread.join(); }
 
-		// if container changed size it means there are tokens in the output
-		if(size_difference > 0)
+		// if any of the threads failed rethrow the exception
+		for (const auto& error : errors)
 		{
-			// add the last item using the last position
-			const std::string_view token(read_data.data() + (last_pos + 1));
-			mtl::emplace_back(split_lines, token);
+			if (error) { std::rethrow_exception(error); }
 		}
 
+		// add all the lines to the container in order
+		size_t total_size = split_lines.size();
+		for (const auto& lines : chunk_lines) { total_size += lines.size(); }
+		mtl::reserve(split_lines, total_size);
 
-		// if the container's size didn't change at all then add the entire input string because
-		// it means there are no places that it needs to be split
-		if (size_difference == 0)
-		{ 
-			mtl::emplace_back(split_lines, read_data); 
+		for (auto& lines : chunk_lines)
+		{
+			for (auto& line : lines)
+			{
+				mtl::emplace_back(split_lines, std::move(line));
+			}
 		}
 	}
 
@@ -243,79 +827,3322 @@ inline bool read_all_lines(const std::filesystem::path& filename, Container& rea
 }
 
 
-// ================================================================================================
-// WRITE_FILE       - Writes a string to a file.
-// ================================================================================================
+/// Read an entire file in lines using multiple threads to split the lines. The filename is used
+/// to specify which file to read. The read_lines is where the file will be placed. The file is
+/// memory-mapped and divided in chunks at newlines, each chunk is split on its own thread. The
+/// lines are exactly the same as the ones produced by mtl::filesystem::read_all_lines. A 
+/// thread_count of 0 uses as many threads as the hardware supports. Small files are split on a
+/// single thread. The container element type has to be std::string. Returns if the file was read
+/// successfully.
+/// @param[in] filename The relative or absolute path to a file.
+/// @param[out] read_lines A container with element type std::string to store the read lines.
+/// @param[in] thread_count An optional number of threads to use.
+/// @return Returns if all the lines were read successfully.
+template<typename Container>
+inline bool read_all_lines_parallel(const std::filesystem::path& filename, Container& read_lines,
+									const size_t thread_count = 0)
+{
+	mtl::filesystem::mapped_file mapped;
+	// try to map the file
+	if (mtl::filesystem::read_file(filename, mapped) == false) { return false; }
+	
+	// check that the file is not empty before we try to split it
+	if (mapped.empty() == false)
+	{
+		// split each line to an output container at each newline using multiple threads
+		mtl::filesystem::detail::parallel_split_crlf(mapped.view(), read_lines, thread_count);
+		// if the last element is empty remove it, we are sure that the output is not empty
+		// because we know that the file is bigger than 0 if we reached this point
+		if (read_lines.back().empty())
+		{
+			read_lines.pop_back();
+		}
+	}
+	return true;
+}
 
 
-/// Write an std::string to a file. The filename is used to specify which file to write. The
-/// write_data is what to write to the file. Append if set to true adds to the end of the
-/// file instead of overwriting it. Returns if the file was written successfully.
-/// @param[in] filename The relative or absolute path to a file.
-/// @param[in] write_data An std::string to write to the file.
-/// @param[in] append An optional boolean to and append to the end of the file or overwrite it.
-/// @return Returns if the file was written successfully.
-inline bool write_file(const std::filesystem::path& filename, const std::string& write_data,
-					   const bool append = false)
+/// Holds the contents of a file together with all of its lines as std::string_view. The lines
+/// point inside the buffer the file was read to, either an owned buffer or a memory-mapped file,
+/// so there is a single allocation for the buffer and one for the lines instead of one for each
+/// line. The lines remain valid for as long as the mtl::filesystem::file_lines is alive. Can be
+/// moved but not copied.
+class file_lines : mtl::no_copy
 {
-	// what mode to open the file
-	std::ios_base::openmode open_mode = std::ios::out;
-	// set the mask to binary mode so it works better in Windows when reading newlines
-	open_mode = (open_mode | std::ios::binary);
-	// should we overwrite or append to the file
-	if (append) { open_mode = (open_mode | std::ios::app); }
+	// Memory-mapped file when the file is read using memory mapping.
+	mtl::filesystem::mapped_file _mapped;
+	// Owned buffer when the file is read to the heap. Kept behind a pointer so moving does not
+	// invalidate the lines when the std::string uses the small string optimization.
+	std::unique_ptr<std::string> _buffer;
+	// All the lines of the file.
+	std::vector<std::string_view> _lines;
 
-	// std::ofstream is RAII wrapper and will close correctly if an exception is thrown
-	std::ofstream out_file(filename, open_mode);
-	// if we can't open the file it is an error
-	if (out_file.is_open() == false) { return false; } // GCOVR_EXCL_LINE
+public:
 
-	// enable exceptions for std::ofstream
-	out_file.exceptions(std::ofstream::badbit | std::ofstream::failbit);
+	// ============================================================================================
+	// OPEN - Reads a file and splits it in lines.
+	// ============================================================================================
 
-	// write the data to file
+	/// Reads a file and splits it in lines using the same rules as 
+	/// mtl::filesystem::read_all_lines. Anything previously held is released. Returns if the file
+	/// was read successfully.
+	/// @param[in] filename The relative or absolute path to a file.
+	/// @param[in] memory_map An optional boolean to memory-map the file instead of reading it.
+	/// @return Returns if the file was read successfully.
+	bool open(const std::filesystem::path& filename, const bool memory_map = true)
+	{
+		close();
+
+		std::string_view contents;
+		if (memory_map)
+		{
+			if (mtl::filesystem::read_file(filename, _mapped) == false) { return false; }
+			contents = _mapped.view();
+		}
+		else
+		{
+			_buffer = std::make_unique<std::string>();
+			if (mtl::filesystem::read_file(filename, *_buffer) == false) { return false; }
+			contents = *_buffer;
+		}
+
+		// check that the buffer is not empty before we try to split it
+		if (contents.empty() == false)
+		{
+			mtl::filesystem::detail::specialized_split_crlf(contents, _lines);
+			// if the last element is empty remove it, we are sure that the output is not empty
+			// because we know that the buffer is bigger than 0 if we reached this point
+			if (_lines.back().empty())
+			{
+				_lines.pop_back();
+			}
+		}
+		return true;
+	}
+
+	// ============================================================================================
+	// CLOSE - Releases the buffer and all the lines.
+	// ============================================================================================
+
+	/// Releases the buffer and all the lines.
+	void close() noexcept
+	{
+		_lines.clear();
+		_buffer.reset();
+		_mapped.close();
+	}
+
+	// ============================================================================================
+	// LINES - Returns all the lines.
+	// ============================================================================================
+
+	/// Returns all the lines.
+	/// @return An std::vector of std::string_view with all the lines.
+	[[nodiscard]]
+	const std::vector<std::string_view>& lines() const noexcept { return _lines; }
+
+	// ============================================================================================
+	// SIZE, EMPTY, OPERATOR[], BEGIN, END - Access to the lines.
+	// ============================================================================================
+
+	/// Returns the number of lines.
+	/// @return The number of lines.
+	[[nodiscard]]
+	size_t size() const noexcept { return _lines.size(); }
+
+	/// Returns if there are no lines.
+	/// @return If there are no lines.
+	[[nodiscard]]
+	bool empty() const noexcept { return _lines.empty(); }
+
+	/// Returns the line at the given index without bounds checking.
+	/// @param[in] index The index of the line.
+	/// @return An std::string_view of the line.
+	[[nodiscard]]
+	std::string_view operator[](const size_t index) const noexcept { return _lines[index]; }
+
+	/// Returns an iterator to the first line.
+	/// @return An iterator to the first line.
+	[[nodiscard]]
+	auto begin() const noexcept { return _lines.cbegin(); }
+
+	/// Returns an iterator past the last line.
+	/// @return An iterator past the last line.
+	[[nodiscard]]
+	auto end() const noexcept { return _lines.cend(); }
+};
+
+
+/// Read an entire file in lines without allocating memory for each line. The filename is used to
+/// specify which file to read. The read_lines is where the file and its lines will be placed, the
+/// lines are std::string_view pointing inside the file buffer. If memory_map is true the file is
+/// memory-mapped instead of being copied to the heap. Returns if the file was read successfully.
+/// @param[in] filename The relative or absolute path to a file.
+/// @param[out] read_lines An mtl::filesystem::file_lines to store the file and the read lines.
+/// @param[in] memory_map An optional boolean to memory-map the file instead of reading it.
+/// @return Returns if all the lines were read successfully.
+inline bool read_all_lines(const std::filesystem::path& filename,
+						   mtl::filesystem::file_lines& read_lines, const bool memory_map = true)
+{
+	return read_lines.open(filename, memory_map);
+}
+
+
+// ================================================================================================
+// LINE_READER      - Reads a file line by line using a bounded amount of memory.
+// ================================================================================================
+
+
+/// Reads a file line by line in fixed-size chunks so files of any size can be processed using a
+/// constant amount of memory. Uses the same rules for LF and CRLF as 
+/// mtl::filesystem::read_all_lines and produces exactly the same lines. Each line is an 
+/// std::string_view that is valid until the next line is read. Lines that are longer than the
+/// chunk size grow the internal buffer to fit them. Can be used in a range-based for loop. Can be
+/// moved but not copied.
+class line_reader : mtl::no_copy
+{
+	// The file we read from.
+	std::ifstream _file;
+	// Buffer that holds the current chunk of the file.
+	std::vector<char> _buffer;
+	// Position in the buffer where the next line starts.
+	size_t _start = 0;
+	// Position in the buffer where the valid data ends.
+	size_t _end = 0;
+	// If we reached the end of the file.
+	bool _eof = true;
+
+	// Moves the unread data to the front of the buffer and fills the rest of the buffer from the
+	// file. Grows the buffer if it is completely full with a single line. Returns if any new data
+	// was read.
+	bool refill()
+	{
+		const size_t remaining = _end - _start;
+		if ((remaining > 0) && (_start > 0))
+		{
+			std::memmove(_buffer.data(), _buffer.data() + _start, remaining);
+		}
+		_start = 0;
+		_end = remaining;
+
+		// the line doesn't fit in the buffer so we have to make the buffer larger
+		if (_end == _buffer.size())
+		{
+			_buffer.resize(_buffer.size() * 2);
+		}
+
+		_file.read(_buffer.data() + _end, static_cast<std::streamsize>(_buffer.size() - _end));
+		const auto count = static_cast<size_t>(_file.gcount());
+		_end += count;
+		if (_file.eof()) { _eof = true; }
+		return (count > 0);
+	}
+
+public:
+
+	// ============================================================================================
+	// LINE_READER - Constructors.
+	// ============================================================================================
+
+	/// Default constructor that doesn't open any file.
+	line_reader() = default;
+
+	/// Constructor that opens a file for reading line by line. Use is_open to check if it was
+	/// successful.
+	/// @param[in] filename The relative or absolute path to a file.
+	/// @param[in] chunk_size An optional size in bytes for each chunk read from the file.
+	explicit line_reader(const std::filesystem::path& filename, const size_t chunk_size = 65536)
+	{
+		open(filename, chunk_size);
+	}
+
+	// ============================================================================================
+	// OPEN - Opens a file for reading line by line.
+	// ============================================================================================
+
+	/// Opens a file for reading line by line. If another file was already open it is closed first.
+	/// Returns if the file was opened successfully.
+	/// @param[in] filename The relative or absolute path to a file.
+	/// @param[in] chunk_size An optional size in bytes for each chunk read from the file.
+	/// @return Returns if the file was opened successfully.
+	bool open(const std::filesystem::path& filename, const size_t chunk_size = 65536)
+	{
+
+#ifndef MTL_DISABLE_SOME_ASSERTS
+		// when in debug mode check the file we want to open exists and assert if it doesn't
+		MTL_ASSERT_MSG(std::filesystem::is_regular_file(filename),
+					   "File doesn't exist or incorrect path given.");
+#endif // MTL_DISABLE_SOME_ASSERTS end
+
+		close();
+
+		_file.open(filename, std::ios::in | std::ios::binary);
+		if (_file.is_open() == false) { return false; }
+
+		// enable exceptions for std::ifstream, do not use std::ifstream::failbit as it is set
+		// when EOF is reached and it throws an exception even when there is no actual error
+		_file.exceptions(std::ifstream::badbit);
+
+		// a chunk size of 0 makes no sense so use the smallest possible size instead
+		_buffer.resize(chunk_size > 0 ? chunk_size : 1);
+		_eof = false;
+		return true;
+	}
+
+	// ============================================================================================
+	// CLOSE - Closes the file.
+	// ============================================================================================
+
+	/// Closes the file and releases the buffer.
+	void close()
+	{
+		if (_file.is_open()) { _file.close(); }
+		_file.clear();
+		_buffer.clear();
+		_buffer.shrink_to_fit();
+		_start = 0;
+		_end = 0;
+		_eof = true;
+	}
+
+	// ============================================================================================
+	// IS_OPEN - Returns if a file is open.
+	// ============================================================================================
+
+	/// Returns if a file is open.
+	/// @return If a file is open.
+	[[nodiscard]]
+	bool is_open() const { return _file.is_open(); }
+
+	// ============================================================================================
+	// NEXT - Reads the next line.
+	// ============================================================================================
+
+	/// Reads the next line. Returns false when there are no more lines. The line is valid until
+	/// the next call to next or until the mtl::filesystem::line_reader is closed.
+	/// @param[out] line An std::string_view where the line will be stored.
+	/// @return Returns if a line was read.
+	bool next(std::string_view& line)
+	{
+		size_t search_from = _start;
+		while (true)
+		{
+			const char* match = nullptr;
+			if (search_from < _end)
+			{
+				match = static_cast<const char*>(
+					std::memchr(_buffer.data() + search_from, '\n', _end - search_from));
+			}
+
+			// we found a newline
+			if (match != nullptr)
+			{
+				const auto match_pos = static_cast<size_t>(match - _buffer.data());
+				size_t line_end = match_pos;
+				// crlf case
+				if ((line_end > _start) && (_buffer[line_end - 1] == '\r')) { --line_end; }
+				line = std::string_view(_buffer.data() + _start, line_end - _start);
+				_start = match_pos + 1;
+				return true;
+			}
+
+			// there is no newline and no more data so whatever is left is the last line
+			if (_eof)
+			{
+				if (_start < _end)
+				{
+					line = std::string_view(_buffer.data() + _start, _end - _start);
+					_start = _end;
+					return true;
+				}
+				return false;
+			}
+
+			// the line continues in the next chunk, we don't need to search again what we have
+			// already searched
+			const size_t searched = _end - _start;
+			refill();
+			search_from = _start + searched;
+		}
+	}
+
+	// ============================================================================================
+	// ITERATOR - Input iterator for using mtl::filesystem::line_reader in a range-based for loop.
+	// ============================================================================================
+
+	/// Input iterator over the lines of an mtl::filesystem::line_reader.
+	class iterator
+	{
+		// The line reader we iterate over, nullptr for the end iterator.
+		line_reader* _reader = nullptr;
+		// The current line.
+		std::string_view _line;
+
+	public:
+
+		// some typedefs needed for proper iterator declaration
+
+		// The typedef for iterator type.
+		using value_type = std::string_view;
+		// The typedef for iterator difference.
+		using difference_type = std::ptrdiff_t;
+		// The typedef for iterator category.
+		using iterator_category = std::input_iterator_tag;
+		// The typedef for iterator pointer type.
+		using pointer = const std::string_view*;
+		// The typedef for iterator reference type.
+		using reference = const std::string_view&;
+
+		// Constructor for the end iterator.
+		iterator() = default;
+
+		// Constructor that reads the first line.
+		explicit iterator(line_reader* reader) : _reader(reader) { ++(*this); }
+
+		// Returns the current line.
+		[[nodiscard]]
+		reference operator*() const { return _line; }
+
+		// Returns a pointer to the current line.
+		[[nodiscard]]
+		pointer operator->() const { return &_line; }
+
+		// Pre increment operator that reads the next line.
+		iterator& operator++()
+		{
+			if ((_reader != nullptr) && (_reader->next(_line) == false)) { _reader = nullptr; }
+			return *this;
+		}
+
+		// Equality operator.
+		[[nodiscard]]
+		bool operator==(const iterator& other) const { return _reader == other._reader; }
+
+		// Difference operator.
+		[[nodiscard]]
+		bool operator!=(const iterator& other) const { return !(*this == other); }
+	};
+
+	/// Returns an iterator that reads the next line.
+	/// @return An iterator to the next line.
+	[[nodiscard]]
+	iterator begin() { return iterator(this); }
+
+	/// Returns the end iterator.
+	/// @return The end iterator.
+	[[nodiscard]]
+	iterator end() { return iterator(); }
+};
+
+
+
+// ================================================================================================
+// CSV_READER       - Reads CSV and TSV files record by record using a bounded amount of memory.
+// ================================================================================================
+
+
+/// Reads CSV, TSV and other delimiter separated files record by record in fixed-size chunks so
+/// files of any size can be processed using a constant amount of memory. Fields can be quoted
+/// with double quotes, quoted fields can contain the delimiter, newlines and double quotes written
+/// as two double quotes. Records can end with LF or CRLF and empty lines are records without
+/// fields. Each field is an std::string_view into the internal buffer that is valid until the
+/// next record is read, so reading a record doesn't allocate any memory. Delimiters and newlines
+/// are found with SSE2 or AVX2 when available. When only some columns are selected the fields of
+/// the other columns are skipped and never unescaped or stored. Can be moved but not copied.
+class csv_reader : mtl::no_copy
+{
+	// The position of a field in the buffer.
+	struct field_span
+	{
+		// Position in the buffer where the field starts.
+		size_t begin = 0;
+		// Position in the buffer where the field ends.
+		size_t end = 0;
+		// If the field contains double quotes written as two double quotes.
+		bool escaped = false;
+	};
+
+	// The file we read from.
+	std::ifstream _file;
+	// Buffer that holds the current chunk of the file.
+	std::vector<char> _buffer;
+	// Position in the buffer where the next record starts.
+	size_t _start = 0;
+	// Position in the buffer where the valid data ends.
+	size_t _end = 0;
+	// If we reached the end of the file.
+	bool _eof = true;
+	// The character that separates fields.
+	char _delimiter = ',';
+	// The selected columns in the order they are returned, empty when all columns are returned.
+	std::vector<size_t> _columns;
+	// For each column if it is selected, empty when all columns are returned.
+	std::vector<bool> _selected;
+	// The positions of the fields of the current record, indexed by column.
+	std::vector<field_span> _spans;
+
+	// Moves the unread data to the front of the buffer and fills the rest of the buffer from the
+	// file. Grows the buffer if it is completely full with a single record. Returns if any new
+	// data was read.
+	bool refill()
+	{
+		const size_t remaining = _end - _start;
+		if ((remaining > 0) && (_start > 0))
+		{
+			std::memmove(_buffer.data(), _buffer.data() + _start, remaining);
+		}
+		_start = 0;
+		_end = remaining;
+
+		// the record doesn't fit in the buffer so we have to make the buffer larger
+		if (_end == _buffer.size())
+		{
+			_buffer.resize(_buffer.size() * 2);
+		}
+
+		_file.read(_buffer.data() + _end, static_cast<std::streamsize>(_buffer.size() - _end));
+		const auto count = static_cast<size_t>(_file.gcount());
+		_end += count;
+		if (_file.eof()) { _eof = true; }
+		return (count > 0);
+	}
+
+	// Stores the position of a field if its column is selected.
+	void store_field(const size_t column, const size_t begin, const size_t end, 
+					 const bool escaped)
+	{
+		if ((_selected.empty() == false) && 
+			((column >= _selected.size()) || (_selected[column] == false)))
+		{
+			return;
+		}
+		if (column >= _spans.size()) { _spans.resize(column + 1); }
+		_spans[column] = field_span { begin, end, escaped };
+	}
+
+	// Finds the fields of the record that starts at the start of the unread data. Returns the
+	// position right after the record or std::string_view::npos if the rest of the record isn't
+	// in the buffer yet. The column count is the number of fields the record has.
+	size_t parse_record(size_t& column_count)
+	{
+		constexpr auto npos = std::string_view::npos;
+		const char* data = _buffer.data();
+		_spans.clear();
+		column_count = 0;
+		size_t pos = _start;
+
+		while (true)
+		{
+			// a quoted field ends at a double quote that isn't followed by another double quote
+			if ((pos < _end) && (data[pos] == '"'))
+			{
+				const size_t field_begin = pos + 1;
+				size_t search_from = field_begin;
+				bool escaped = false;
+				while (true)
+				{
+					const char* quote = nullptr;
+					if (search_from < _end)
+					{
+						quote = static_cast<const char*>(
+							std::memchr(data + search_from, '"', _end - search_from));
+					}
+
+					// the closing quote is missing
+					if (quote == nullptr)
+					{
+						if (_eof == false) { return npos; }
+						store_field(column_count++, field_begin, _end, escaped);
+						return _end;
+					}
+
+					const auto quote_pos = static_cast<size_t>(quote - data);
+					// we can't tell yet if the quote is followed by another quote
+					if ((quote_pos + 1 == _end) && (_eof == false)) { return npos; }
+					if ((quote_pos + 1 < _end) && (data[quote_pos + 1] == '"'))
+					{
+						escaped = true;
+						search_from = quote_pos + 2;
+						continue;
+					}
+
+					store_field(column_count++, field_begin, quote_pos, escaped);
+					pos = quote_pos + 1;
+					break;
+				}
+
+				// anything between the closing quote and the next delimiter or newline is ignored
+				const std::string_view rest(data + pos, _end - pos);
+				const size_t match = mtl::string::detail::find_first_of_two(rest, _delimiter, '\n');
+				if (match == npos) { return (_eof ? _end : npos); }
+				pos += match;
+				if (data[pos] == '\n') { return pos + 1; }
+				++pos;
+				continue;
+			}
+
+			// an unquoted field ends at the next delimiter or newline
+			const std::string_view rest(data + pos, _end - pos);
+			const size_t match = mtl::string::detail::find_first_of_two(rest, _delimiter, '\n');
+			if (match == npos)
+			{
+				if (_eof == false) { return npos; }
+				store_field(column_count++, pos, _end, false);
+				return _end;
+			}
+
+			const size_t field_end = pos + match;
+			if (data[field_end] == '\n')
+			{
+				// crlf case
+				size_t line_end = field_end;
+				if ((line_end > pos) && (data[line_end - 1] == '\r')) { --line_end; }
+				// an empty line is a record without fields
+				if ((column_count == 0) && (line_end == pos)) { return field_end + 1; }
+				store_field(column_count++, pos, line_end, false);
+				return field_end + 1;
+			}
+
+			store_field(column_count++, pos, field_end, false);
+			pos = field_end + 1;
+		}
+	}
+
+	// Returns the field of a column, unescaping it first if needed.
+	std::string_view field(const size_t column)
+	{
+		if (column >= _spans.size()) { return std::string_view(); }
+		auto& span = _spans[column];
+		char* data = _buffer.data() + span.begin;
+		if (span.escaped)
+		{
+			// replace every two double quotes with a single double quote in place, the unescaped
+			// field is never longer so it fits where the escaped field was
+			const size_t length = span.end - span.begin;
+			size_t write_pos = 0;
+			for (size_t read_pos = 0; read_pos < length; ++read_pos, ++write_pos)
+			{
+				data[write_pos] = data[read_pos];
+				if ((data[read_pos] == '"') && (read_pos + 1 < length)) { ++read_pos; }
+			}
+			span.end = span.begin + write_pos;
+			span.escaped = false;
+		}
+		return std::string_view(data, span.end - span.begin);
+	}
+
+public:
+
+	// ============================================================================================
+	// CSV_READER - Constructors.
+	// ============================================================================================
+
+	/// Default constructor that doesn't open any file.
+	csv_reader() = default;
+
+	/// Constructor that opens a file for reading record by record. Use is_open to check if it was
+	/// successful.
+	/// @param[in] filename The relative or absolute path to a file.
+	/// @param[in] delimiter An optional character that separates fields, use '\t' for TSV files.
+	/// @param[in] chunk_size An optional size in bytes for each chunk read from the file.
+	explicit csv_reader(const std::filesystem::path& filename, const char delimiter = ',', 
+						const size_t chunk_size = 65536)
+	{
+		open(filename, delimiter, chunk_size);
+	}
+
+	// ============================================================================================
+	// OPEN - Opens a file for reading record by record.
+	// ============================================================================================
+
+	/// Opens a file for reading record by record. If another file was already open it is closed
+	/// first. The selected columns are kept. Returns if the file was opened successfully. The
+	/// delimiter can't be a double quote or a newline.
+	/// @param[in] filename The relative or absolute path to a file.
+	/// @param[in] delimiter An optional character that separates fields, use '\t' for TSV files.
+	/// @param[in] chunk_size An optional size in bytes for each chunk read from the file.
+	/// @return Returns if the file was opened successfully.
+	bool open(const std::filesystem::path& filename, const char delimiter = ',', 
+			  const size_t chunk_size = 65536)
+	{
+
+#ifndef MTL_DISABLE_SOME_ASSERTS
+		// when in debug mode check the file we want to open exists and assert if it doesn't
+		MTL_ASSERT_MSG(std::filesystem::is_regular_file(filename),
+					   "File doesn't exist or incorrect path given.");
+#endif // MTL_DISABLE_SOME_ASSERTS end
+
+		close();
+
+		// the delimiter can't be a character that has another meaning
+		if ((delimiter == '"') || (delimiter == '\n') || (delimiter == '\r')) { return false; }
+		_delimiter = delimiter;
+
+		_file.open(filename, std::ios::in | std::ios::binary);
+		if (_file.is_open() == false) { return false; }
+
+		// enable exceptions for std::ifstream, do not use std::ifstream::failbit as it is set
+		// when EOF is reached and it throws an exception even when there is no actual error
+		_file.exceptions(std::ifstream::badbit);
+
+		// a chunk size of 0 makes no sense so use the smallest possible size instead
+		_buffer.resize(chunk_size > 0 ? chunk_size : 1);
+		_eof = false;
+		return true;
+	}
+
+	// ============================================================================================
+	// CLOSE - Closes the file.
+	// ============================================================================================
+
+	/// Closes the file and releases the buffer.
+	void close()
+	{
+		if (_file.is_open()) { _file.close(); }
+		_file.clear();
+		_buffer.clear();
+		_buffer.shrink_to_fit();
+		_spans.clear();
+		_start = 0;
+		_end = 0;
+		_eof = true;
+	}
+
+	// ============================================================================================
+	// IS_OPEN - Returns if a file is open.
+	// ============================================================================================
+
+	/// Returns if a file is open.
+	/// @return If a file is open.
+	[[nodiscard]]
+	bool is_open() const { return _file.is_open(); }
+
+	// ============================================================================================
+	// SELECT_COLUMNS - Selects which columns are returned.
+	// ============================================================================================
+
+	/// Selects which columns are returned for each record and in which order, columns are counted
+	/// from 0. The fields of the columns that are not selected are skipped. When a record has
+	/// fewer fields than a selected column an empty field is returned for that column. An empty
+	/// container selects all the columns.
+	/// @param[in] columns A container with the indices of the columns to return.
+	template<typename Container>
+	void select_columns(const Container& columns)
+	{
+		_columns.assign(std::begin(columns), std::end(columns));
+		_selected.clear();
+		for (const auto column : _columns)
+		{
+			if (column >= _selected.size()) { _selected.resize(column + 1, false); }
+			_selected[column] = true;
+		}
+	}
+
+	/// Selects which columns are returned for each record and in which order, columns are counted
+	/// from 0. The fields of the columns that are not selected are skipped. When a record has
+	/// fewer fields than a selected column an empty field is returned for that column. An empty
+	/// list selects all the columns.
+	/// @param[in] columns A list with the indices of the columns to return.
+	void select_columns(std::initializer_list<size_t> columns)
+	{
+		select_columns(std::vector<size_t>(columns));
+	}
+
+	// ============================================================================================
+	// NEXT - Reads the next record.
+	// ============================================================================================
+
+	/// Reads the next record and stores its fields to the given vector, replacing whatever it had.
+	/// Returns false when there are no more records. The fields are valid until the next call to
+	/// next or until the mtl::filesystem::csv_reader is closed.
+	/// @param[out] fields An std::vector of std::string_view where the fields will be stored.
+	/// @return Returns if a record was read.
+	bool next(std::vector<std::string_view>& fields)
+	{
+		fields.clear();
+		while (true)
+		{
+			if ((_start >= _end) && _eof) { return false; }
+
+			size_t column_count = 0;
+			const size_t record_end = parse_record(column_count);
+			if (record_end == std::string_view::npos)
+			{
+				// the record continues in the next chunk
+				refill();
+				continue;
+			}
+
+			if (_columns.empty())
+			{
+				for (size_t column = 0; column < column_count; ++column)
+				{
+					fields.push_back(field(column));
+				}
+			}
+			else
+			{
+				for (const auto column : _columns) { fields.push_back(field(column)); }
+			}
+
+			_start = record_end;
+			return true;
+		}
+	}
+};
+
+
+
+// ================================================================================================
+// WRITE_FILE       - Writes a string to a file.
+// ================================================================================================
+
+
+/// Write an std::string to a file. The filename is used to specify which file to write. The
+/// write_data is what to write to the file. Append if set to true adds to the end of the
+/// file instead of overwriting it. Returns if the file was written successfully.
+/// @param[in] filename The relative or absolute path to a file.
+/// @param[in] write_data An std::string to write to the file.
+/// @param[in] append An optional boolean to and append to the end of the file or overwrite it.
+/// @return Returns if the file was written successfully.
+inline bool write_file(const std::filesystem::path& filename, const std::string& write_data,
+					   const bool append = false)
+{
+	// what mode to open the file
+	std::ios_base::openmode open_mode = std::ios::out;
+	// set the mask to binary mode so it works better in Windows when reading newlines
+	open_mode = (open_mode | std::ios::binary);
+	// should we overwrite or append to the file
+	if (append) { open_mode = (open_mode | std::ios::app); }
+
+	// std::ofstream is RAII wrapper and will close correctly if an exception is thrown
+	std::ofstream out_file(filename, open_mode);
+	// if we can't open the file it is an error
+	if (out_file.is_open() == false) { return false; } // GCOVR_EXCL_LINE
+
+	// enable exceptions for std::ofstream
+	out_file.exceptions(std::ofstream::badbit | std::ofstream::failbit);
+
+	// write the data to file
 	out_file.write(write_data.data(), static_cast<std::streamsize>(write_data.size()));
 
-	// if we reached this point it means we succeeded
+	// if we reached this point it means we succeeded
+	return true;
+}
+
+
+
+// ================================================================================================
+// ASYNC_WRITER     - Writes to a file on a background thread.
+// ================================================================================================
+
+
+/// Writes to a file on a background thread so the callers never block on the disk. Everything 
+/// written is appended to a single pending buffer under a short lock, the background thread swaps
+/// the pending buffer with its own and writes it to the file in one large write, so many small
+/// writes are coalesced together. Data is written in the same order it was given. Opening uses
+/// the same modes as mtl::filesystem::write_file, the file is either overwritten or appended to.
+/// When the pending buffer grows beyond the maximum pending size the callers wait for the
+/// background thread to catch up. Can't be copied or moved.
+class async_writer : mtl::no_move
+{
+	// The file we write to.
+	std::ofstream _file;
+	// The background thread that writes to the file.
+	std::thread _worker;
+	// Protects everything below.
+	std::mutex _mutex;
+	// Wakes the background thread when there is work to do.
+	std::condition_variable _work_available;
+	// Wakes callers waiting for data to be written.
+	std::condition_variable _work_done;
+	// Data waiting to be written.
+	std::string _pending;
+	// Maximum size for the pending data before callers have to wait.
+	size_t _max_pending = 0;
+	// Total number of bytes given to write.
+	std::uintmax_t _submitted = 0;
+	// Total number of bytes that have been written and flushed to the operating system.
+	std::uintmax_t _flushed = 0;
+	// If a caller is waiting for a flush.
+	bool _flush_requested = false;
+	// If the background thread has to stop.
+	bool _stop = false;
+	// If any write failed.
+	bool _failed = false;
+	// If a file is open.
+	bool _open = false;
+
+	// The loop that runs on the background thread.
+	void worker_loop()
+	{
+		std::string buffer;
+		std::unique_lock<std::mutex> lock(_mutex);
+		while (true)
+		{
+			_work_available.wait(lock, [this]() 
+			{ 
+				return (_stop || _flush_requested || (_pending.empty() == false)); 
+			});
+
+			if (_stop && _pending.empty())
+			{
+				// the loop won't run again so a flush requested while closing is done here
+				if (_flush_requested)
+				{
+					try
+					{
+						_file.flush();
+					}
+					// GCOVR_EXCL_START
+					catch (...)
+					{
+						_failed = true;
+					}
+					// GCOVR_EXCL_STOP
+					_flushed = _submitted;
+					_flush_requested = false;
+					_work_done.notify_all();
+				}
+				break;
+			}
+
+			// take everything that is pending so the callers can continue writing
+			buffer.swap(_pending);
+			const std::uintmax_t target = _submitted;
+			const bool flush = _flush_requested;
+			_flush_requested = false;
+			lock.unlock();
+			// there is space in the pending buffer again
+			_work_done.notify_all();
+
+			bool success = true;
+			try
+			{
+				_file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+				if (flush) { _file.flush(); }
+			}
+			catch (...)
+			{
+				success = false;
+			}
+			buffer.clear();
+
+			lock.lock();
+			if (success == false) { _failed = true; }
+			if (flush) { _flushed = target; }
+			_work_done.notify_all();
+		}
+	}
+
+public:
+
+	// ============================================================================================
+	// ASYNC_WRITER - Constructors and destructor.
+	// ============================================================================================
+
+	/// Default constructor that doesn't open any file.
+	async_writer() = default;
+
+	/// Constructor that opens a file for writing. Use is_open to check if it was successful.
+	/// @param[in] filename The relative or absolute path to a file.
+	/// @param[in] append An optional boolean to append to the end of the file or overwrite it.
+	/// @param[in] max_pending An optional maximum size in bytes for the data waiting to be written.
+	explicit async_writer(const std::filesystem::path& filename, const bool append = false,
+						  const size_t max_pending = 64 * 1024 * 1024)
+	{
+		open(filename, append, max_pending);
+	}
+
+	/// Destructor that writes everything that is pending and closes the file.
+	~async_writer() { close(); }
+
+	// ============================================================================================
+	// OPEN - Opens a file for writing and starts the background thread.
+	// ============================================================================================
+
+	/// Opens a file for writing and starts the background thread. If another file was already
+	/// open it is closed first. Returns if the file was opened successfully.
+	/// @param[in] filename The relative or absolute path to a file.
+	/// @param[in] append An optional boolean to append to the end of the file or overwrite it.
+	/// @param[in] max_pending An optional maximum size in bytes for the data waiting to be written.
+	/// @return Returns if the file was opened successfully.
+	bool open(const std::filesystem::path& filename, const bool append = false,
+			  const size_t max_pending = 64 * 1024 * 1024)
+	{
+		close();
+
+		// what mode to open the file
+		std::ios_base::openmode open_mode = std::ios::out;
+		// set the mask to binary mode so it works better in Windows when reading newlines
+		open_mode = (open_mode | std::ios::binary);
+		// should we overwrite or append to the file
+		if (append) { open_mode = (open_mode | std::ios::app); }
+
+		_file.open(filename, open_mode);
+		// if we can't open the file it is an error
+		if (_file.is_open() == false) { return false; } // GCOVR_EXCL_LINE
+
+		// enable exceptions for std::ofstream
+		_file.exceptions(std::ofstream::badbit | std::ofstream::failbit);
+
+		_max_pending = (max_pending > 0) ? max_pending : 1;
+		_submitted = 0;
+		_flushed = 0;
+		_flush_requested = false;
+		_stop = false;
+		_failed = false;
+		_open = true;
+		_worker = std::thread(&async_writer::worker_loop, this);
+		return true;
+	}
+
+	// ============================================================================================
+	// WRITE - Queues data to be written to the file.
+	// ============================================================================================
+
+	/// Queues data to be written to the file by the background thread. Returns immediately unless
+	/// the pending data is larger than the maximum pending size. Returns false if no file is open,
+	/// if the file is closed while waiting or if a previous write failed.
+	/// @param[in] write_data The data to write.
+	/// @return Returns if the data was queued successfully.
+	bool write(std::string_view write_data)
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		if ((_open == false) || _stop || _failed) { return false; }
+		
+		// wait for the background thread to catch up if there is too much pending data
+		_work_done.wait(lock, [this]() 
+		{ 
+			return ((_pending.size() < _max_pending) || _failed || _stop); 
+		});
+		// the file may have been closed while waiting and the data would never be written
+		if (_failed || _stop) { return false; } // GCOVR_EXCL_LINE
+
+		const bool was_empty = _pending.empty();
+		_pending.append(write_data.data(), write_data.size());
+		_submitted += write_data.size();
+		lock.unlock();
+
+		// only wake the background thread when it may be sleeping
+		if (was_empty) { _work_available.notify_one(); }
+		return true;
+	}
+
+	// ============================================================================================
+	// FLUSH - Waits until everything queued so far is written.
+	// ============================================================================================
+
+	/// Waits until everything queued before the call is written and flushed to the operating 
+	/// system. Returns false if no file is open, if the file is being closed or if any write 
+	/// failed.
+	/// @return Returns if everything was written successfully.
+	bool flush()
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		// once closing has started the background thread may already be gone
+		if ((_open == false) || _stop) { return false; }
+
+		const std::uintmax_t target = _submitted;
+		_flush_requested = true;
+		_work_available.notify_one();
+		_work_done.wait(lock, [this, target]() { return ((_flushed >= target) || _failed); });
+		return (_failed == false);
+	}
+
+	// ============================================================================================
+	// CLOSE - Writes everything that is pending and closes the file.
+	// ============================================================================================
+
+	/// Writes everything that is pending, stops the background thread and closes the file. 
+	/// Returns false if no file was open or if any write failed.
+	/// @return Returns if everything was written successfully.
+	bool close()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			if (_open == false) { return false; }
+			_stop = true;
+		}
+		_work_available.notify_one();
+		// wake the callers waiting for space in the pending data so they can give up
+		_work_done.notify_all();
+		_worker.join();
+
+		bool success = (_failed == false);
+		try
+		{
+			_file.close();
+		}
+		// GCOVR_EXCL_START
+		catch (...)
+		{
+			success = false;
+		}
+		// GCOVR_EXCL_STOP
+		_file.clear();
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		_open = false;
+		_pending.clear();
+		_pending.shrink_to_fit();
+		return success;
+	}
+
+	// ============================================================================================
+	// IS_OPEN - Returns if a file is open.
+	// ============================================================================================
+
+	/// Returns if a file is open.
+	/// @return If a file is open.
+	[[nodiscard]]
+	bool is_open()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _open;
+	}
+};
+
+
+
+// ================================================================================================
+// WRITE_ALL_LINES  - Writes all elements of a container to a file.
+// ================================================================================================
+
+
+namespace detail
+{
+
+#if !defined(_WIN32)
+
+	// Writes all the buffers described by the iovec array to a file descriptor with writev. 
+	// Handles partial writes and interrupts. Returns if everything was written.
+	inline bool writev_all(const int fd, iovec* buffers, int count)
+	{
+		while (count > 0)
+		{
+			const ssize_t written = ::writev(fd, buffers, count);
+			if (written < 0)
+			{
+				// interrupted before anything was written so try again
+				if (errno == EINTR) { continue; }
+				return false;
+			}
+
+			// skip all the buffers that were fully written
+			auto remaining = static_cast<size_t>(written);
+			while ((count > 0) && (remaining >= buffers->iov_len))
+			{
+				remaining -= buffers->iov_len;
+				++buffers;
+				--count;
+			}
+
+			// the last buffer was only written partially
+			if (count > 0)
+			{
+				buffers->iov_base = static_cast<char*>(buffers->iov_base) + remaining;
+				buffers->iov_len -= remaining;
+			}
+		}
+		return true;
+	}
+
+	// Writes a range of std::string or std::string_view to new lines in a file. The elements and
+	// newlines are copied to a bounded buffer that is flushed with writev when it is full, so
+	// there are very few system calls. Elements that don't fit in the buffer are not copied, they
+	// are written directly after the buffered data with a single writev.
+	template<typename Iter>
+	inline bool write_all_lines_vectored(const std::filesystem::path& filename, Iter first, 
+										 Iter last, const bool append)
+	{
+		int flags = O_WRONLY | O_CREAT;
+		flags = flags | (append ? O_APPEND : O_TRUNC);
+		const int fd = ::open(filename.c_str(), flags, 0666);
+		if (fd == -1) { return false; } // GCOVR_EXCL_LINE
+
+		// the same as mtl::filesystem::write_all_lines nothing is written when the elements 
+		// joined together are empty
+		bool write = (first != last);
+		if (write && (std::next(first) == last) && (std::string_view(*first).empty()))
+		{
+			write = false;
+		}
+
+		static const char newline = '\n';
+		constexpr size_t capacity = 1024 * 1024;
+		std::unique_ptr<char[]> buffer;
+		if (write) { buffer = std::make_unique<char[]>(capacity); }
+		size_t used = 0;
+		bool success = true;
+
+		for (auto it = first; write && (it != last); ++it)
+		{
+			const std::string_view line(*it);
+
+			// the element and the newline fit in the buffer
+			if (line.size() < capacity - used)
+			{
+				if (line.empty() == false)
+				{
+					std::memcpy(buffer.get() + used, line.data(), line.size());
+				}
+				used += line.size();
+				buffer[used] = '\n';
+				++used;
+			}
+			// the element fits in the buffer after it is flushed
+			else if (line.size() < capacity)
+			{
+				iovec pending { buffer.get(), used };
+				success = writev_all(fd, &pending, 1);
+				if (success == false) { break; } // GCOVR_EXCL_LINE
+				std::memcpy(buffer.get(), line.data(), line.size());
+				used = line.size();
+				buffer[used] = '\n';
+				++used;
+			}
+			// the element is too large for the buffer so write it directly
+			else
+			{
+				std::array<iovec, 3> pending {{ { buffer.get(), used }, 
+												{ const_cast<char*>(line.data()), line.size() },
+												{ const_cast<char*>(&newline), 1 } }};
+				success = writev_all(fd, pending.data(), static_cast<int>(pending.size()));
+				if (success == false) { break; } // GCOVR_EXCL_LINE
+				used = 0;
+			}
+		}
+
+		if (success && (used > 0))
+		{
+			iovec pending { buffer.get(), used };
+			success = writev_all(fd, &pending, 1);
+		}
+
+		// closing can report errors from writing
+		if (::close(fd) != 0) { success = false; } // GCOVR_EXCL_LINE
+		return success;
+	}
+
+#endif // _WIN32 end
+
+} // namespace detail end
+
+
+/// Write a range to new lines in a file. The filename is used to specify which file to write. The
+/// elements in the range from first to last will be written to the file. Append if set to true
+/// adds to the end of the file instead of overwriting it. Returns if the file was written
+/// successfully. When the element type is std::string or std::string_view the elements are
+/// written in bounded chunks without joining the whole range into a single string first.
+/// @param[in] filename The relative or absolute path to a file.
+/// @param[in] first An iterator to the start of a range. Element type can be any type convertible
+///                  to std::string by mtl::string::to_string.
+/// @param[in] last An iterator to the end of a range.
+/// @param[in] append An optional boolean to and append to the end of the file or overwrite it.
+/// @return Returns if all the lines were written successfully.
+template<typename Iter>
+inline bool write_all_lines(const std::filesystem::path& filename, Iter first, Iter last,
+					 		const bool append = false)
+{
+
+#if !defined(_WIN32)
+	using element_type = std::remove_cv_t<typename std::iterator_traits<Iter>::value_type>;
+	// for std::string and std::string_view we can write the elements directly with writev
+	if constexpr (std::is_same_v<element_type, std::string> || 
+				  std::is_same_v<element_type, std::string_view>)
+	{
+		return mtl::filesystem::detail::write_all_lines_vectored(filename, first, last, append);
+	}
+	else
+	{
+#endif // _WIN32 end
+
+	std::string internal_buffer;
+	
+	// join all the elements with \n as a delimiter to an internal_buffer
+	mtl::string::join_all(first, last, internal_buffer, '\n');
+
+	if (internal_buffer.empty() == false)
+	{
+		internal_buffer.push_back('\n');
+	}
+
+	// write to file
+	return mtl::filesystem::write_file(filename, internal_buffer, append);
+
+#if !defined(_WIN32)
+	}
+#endif // _WIN32 end
+}
+
+
+
+
+
+// ================================================================================================
+// WRITE_STATISTICS       - Statistics about how much was written and how fast.
+// WRITE_ALL_LINES_MAPPED - Writes all elements of a container to a file with a single pre-sized
+//                          copy.
+// ================================================================================================
+
+
+/// Statistics about how much was written to a file and how long it took.
+struct write_statistics
+{
+	/// The number of bytes written.
+	std::uintmax_t bytes = 0;
+	/// The time it took to write in seconds.
+	double seconds = 0.0;
+
+	/// Returns how many bytes were written per second.
+	/// @return The throughput in bytes per second.
+	[[nodiscard]]
+	double bytes_per_second() const noexcept
+	{
+		if (seconds <= 0.0) { return 0.0; }
+		return static_cast<double>(bytes) / seconds;
+	}
+};
+
+
+/// Write a range of std::string or std::string_view to new lines in a file. The total size of
+/// the output is computed once from the sizes of the elements, the space for the final size is
+/// reserved and then the file is memory-mapped so all the elements and newlines are copied
+/// directly to the file in a single pass. If the space can't be reserved the output is written
+/// from a single pre-sized buffer instead, which is also how it is written on Windows. The output
+/// is exactly the same as mtl::filesystem::write_all_lines. Stores how many bytes were written
+/// and how long it took to the statistics, so the throughput can be reported with
+/// write_statistics::bytes_per_second. Returns if the file was written successfully.
+/// @param[in] filename The relative or absolute path to a file.
+/// @param[in] first A random access iterator to the start of a range of std::string or
+///                  std::string_view.
+/// @param[in] last A random access iterator to the end of a range.
+/// @param[out] statistics Where the number of written bytes and the time it took will be stored.
+/// @param[in] append An optional boolean to and append to the end of the file or overwrite it.
+/// @return Returns if all the lines were written successfully.
+template<typename Iter>
+inline bool write_all_lines_mapped(const std::filesystem::path& filename, Iter first, Iter last,
+								   mtl::filesystem::write_statistics& statistics,
+								   const bool append = false)
+{
+	using element_type = std::remove_cv_t<typename std::iterator_traits<Iter>::value_type>;
+	using iterator_category = typename std::iterator_traits<Iter>::iterator_category;
+	static_assert(std::is_same_v<element_type, std::string> || 
+				  std::is_same_v<element_type, std::string_view>,
+	"The mtl::filesystem::write_all_lines_mapped requires std::string or std::string_view.");
+	static_assert(std::is_base_of_v<std::random_access_iterator_tag, iterator_category>,
+	"The mtl::filesystem::write_all_lines_mapped requires random access iterators.");
+
+	mtl::chrono::stopwatch timer;
+	timer.start();
+
+	// count the total size of the output, every element is followed by a newline
+	size_t total_size = 0;
+	for (auto it = first; it != last; ++it) { total_size += std::string_view(*it).size() + 1; }
+	
+	// the same as mtl::filesystem::write_all_lines nothing is written when the elements joined
+	// together are empty
+	if (total_size == 1) { total_size = 0; }
+
+	// copies all the elements and newlines to the output that has to be exactly total_size long
+	const auto fill = [first, last, total_size](char* output)
+	{
+		if (total_size == 0) { return; }
+		for (auto it = first; it != last; ++it)
+		{
+			const std::string_view line(*it);
+			if (line.empty() == false)
+			{
+				std::memcpy(output, line.data(), line.size());
+				output += line.size();
+			}
+			*output = '\n';
+			++output;
+		}
+	};
+
+#if defined(_WIN32)
+
+	std::string internal_buffer;
+	internal_buffer.resize(total_size);
+	fill(internal_buffer.data());
+	if (mtl::filesystem::write_file(filename, internal_buffer, append) == false) { return false; }
+
+#else
+
+	int flags = O_RDWR | O_CREAT;
+	if (append == false) { flags = flags | O_TRUNC; }
+	const int fd = ::open(filename.c_str(), flags, 0666);
+	if (fd == -1) { return false; } // GCOVR_EXCL_LINE
+
+	bool success = true;
+	if (total_size > 0)
+	{
+		// when appending the new data start at the end of the existing file
+		struct stat file_stat {};
+		success = (::fstat(fd, &file_stat) == 0);
+		const auto offset = success ? static_cast<std::uintmax_t>(file_stat.st_size) : 0;
+
+		// reserve the blocks for the final size before mapping, writing to a mapping past the
+		// space the filesystem can provide raises SIGBUS instead of reporting an error
+		bool reserved = false;
+#if !defined(__APPLE__)
+		if (success)
+		{
+			reserved = (::posix_fallocate(fd, static_cast<off_t>(offset), 
+										  static_cast<off_t>(total_size)) == 0);
+		}
+#endif // __APPLE__ end
+
+		bool mapped = false;
+		if (reserved)
+		{
+			// the offset for mmap has to be a multiple of the page size
+			const auto page_size = static_cast<std::uintmax_t>(::sysconf(_SC_PAGESIZE));
+			const std::uintmax_t map_offset = offset - (offset % page_size);
+			const auto skip = static_cast<size_t>(offset - map_offset);
+			const size_t map_size = skip + total_size;
+
+			void* address = ::mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+								   static_cast<off_t>(map_offset));
+			if (address != MAP_FAILED)
+			{
+				mapped = true;
+				fill(static_cast<char*>(address) + skip);
+				// the blocks are already reserved so the changes reach the file through the page
+				// cache the same as with write and are not flushed to the disk here
+				success = (::munmap(address, map_size) == 0);
+			}
+		}
+
+		// GCOVR_EXCL_START
+		if (success && (mapped == false))
+		{
+			// the space can't be reserved or the file can't be mapped so undo any growth of the 
+			// file and write it the normal way which reports a full disk as an error
+			success = (::ftruncate(fd, static_cast<off_t>(offset)) == 0);
+			if (success)
+			{
+				std::string internal_buffer;
+				internal_buffer.resize(total_size);
+				fill(internal_buffer.data());
+				iovec buffer { internal_buffer.data(), internal_buffer.size() };
+				success = (::lseek(fd, 0, SEEK_END) != -1) && 
+						  mtl::filesystem::detail::writev_all(fd, &buffer, 1);
+			}
+		}
+		// GCOVR_EXCL_STOP
+	}
+
+	// closing can report errors from writing
+	if (::close(fd) != 0) { success = false; } // GCOVR_EXCL_LINE
+	if (success == false) { return false; }     // GCOVR_EXCL_LINE
+
+#endif // _WIN32 end
+
+	timer.stop();
+	statistics.bytes = total_size;
+	statistics.seconds = timer.elapsed_seconds();
+	return true;
+}
+
+
+/// Write a range of std::string or std::string_view to new lines in a file. The total size of
+/// the output is computed once from the sizes of the elements, the space for the final size is
+/// reserved and then the file is memory-mapped so all the elements and newlines are copied
+/// directly to the file in a single pass. The output is exactly the same as
+/// mtl::filesystem::write_all_lines. Returns if the file was written successfully.
+/// @param[in] filename The relative or absolute path to a file.
+/// @param[in] first A random access iterator to the start of a range of std::string or
+///                  std::string_view.
+/// @param[in] last A random access iterator to the end of a range.
+/// @param[in] append An optional boolean to and append to the end of the file or overwrite it.
+/// @return Returns if all the lines were written successfully.
+template<typename Iter>
+inline bool write_all_lines_mapped(const std::filesystem::path& filename, Iter first, Iter last,
+								   const bool append = false)
+{
+	mtl::filesystem::write_statistics statistics;
+	return mtl::filesystem::write_all_lines_mapped(filename, first, last, statistics, append);
+}
+
+
+
+// ================================================================================================
+// WRITE_FILE_ATOMIC  - Atomically replaces a file so it is never left partially written.
+// WRITE_FILES_ATOMIC - Atomically replaces many files sharing the cost of making them durable.
+// ================================================================================================
+
+
+namespace detail
+{
+
+	// Returns the directory a file is in, for files without a directory it returns the current
+	// directory.
+	[[nodiscard]]
+	inline std::filesystem::path parent_directory(const std::filesystem::path& filename)
+	{
+		auto directory = filename.parent_path();
+		if (directory.empty()) { directory = "."; }
+		return directory;
+	}
+
+	// Returns a new unique name for a temporary file next to the given file. The temporary file
+	// has to be in the same directory so renaming it to the final name is atomic.
+	[[nodiscard]]
+	inline std::filesystem::path temporary_filename(const std::filesystem::path& filename)
+	{
+		static std::atomic<std::uint64_t> counter { 0 };
+
+#if defined(_WIN32)
+		const auto process_id = static_cast<std::uint64_t>(GetCurrentProcessId());
+#else
+		const auto process_id = static_cast<std::uint64_t>(::getpid());
+#endif // _WIN32 end
+
+		auto temporary = filename;
+		temporary += mtl::string::join(".tmp.", process_id, ".", counter.fetch_add(1));
+		return temporary;
+	}
+
+	// Returns the file a symbolic link points to so that replacing it keeps the link and writes
+	// to the file it points to. For anything else, including a link to a file that doesn't exist,
+	// it returns the filename unchanged and the link itself is replaced.
+	[[nodiscard]]
+	inline std::filesystem::path resolve_symlink(const std::filesystem::path& filename)
+	{
+		std::error_code error_code;
+		if (std::filesystem::is_symlink(filename, error_code) == false) { return filename; }
+		auto target = std::filesystem::canonical(filename, error_code);
+		if (error_code) { return filename; }
+		return target;
+	}
+
+	// Creates a new temporary file next to the given file, writes the data to it and makes sure
+	// the data reached the disk. If the file exists the temporary file gets its permissions and
+	// when possible its owner. Returns if it was successful and if it wasn't the temporary file
+	// is removed.
+	inline bool write_durable_temporary(const std::filesystem::path& filename,
+										std::string_view write_data,
+										std::filesystem::path& temporary)
+	{
+		temporary = mtl::filesystem::detail::temporary_filename(filename);
+
+#if defined(_WIN32)
+
+		HANDLE file = CreateFileW(temporary.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_NEW,
+								  FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) { return false; }
+
+		bool success = true;
+		while (success && (write_data.empty() == false))
+		{
+			// WriteFile can only write up to the size of a DWORD at once
+			const auto max_size = static_cast<size_t>(std::numeric_limits<DWORD>::max());
+			const auto size = static_cast<DWORD>(std::min(write_data.size(), max_size));
+			DWORD written = 0;
+			success = (WriteFile(file, write_data.data(), size, &written, nullptr) != 0);
+			write_data.remove_prefix(written);
+		}
+		if (success) { success = (FlushFileBuffers(file) != 0); }
+		if (CloseHandle(file) == 0) { success = false; } // GCOVR_EXCL_LINE
+
+#else
+
+		const int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0666);
+		if (fd == -1) { return false; }
+
+		// the temporary file is created with the default permissions and the current user as
+		// owner, give it the ones of the file it replaces so they don't change after renaming
+		bool success = true;
+		struct stat file_stat {};
+		if (::stat(filename.c_str(), &file_stat) == 0)
+		{
+			// only a privileged user can give a file to another user so the owner is kept only
+			// when possible, it is changed first because changing it can clear the mode bits
+			if ((file_stat.st_uid != ::geteuid()) || (file_stat.st_gid != ::getegid()))
+			{
+				[[maybe_unused]] const int result = ::fchown(fd, file_stat.st_uid, 
+															 file_stat.st_gid);
+			}
+			success = (::fchmod(fd, file_stat.st_mode & 07777) == 0);
+		}
+
+		iovec buffer { const_cast<char*>(write_data.data()), write_data.size() };
+		if (success && (write_data.empty() == false))
+		{
+			success = mtl::filesystem::detail::writev_all(fd, &buffer, 1);
+		}
+		if (success) { success = (::fsync(fd) == 0); }
+		if (::close(fd) != 0) { success = false; } // GCOVR_EXCL_LINE
+
+#endif // _WIN32 end
+
+		if (success == false)
+		{
+			std::error_code error_code;
+			std::filesystem::remove(temporary, error_code);
+		}
+		return success;
+	}
+
+	// Renames the temporary file to the final file replacing it. Returns if it was successful.
+	inline bool replace_with_temporary(const std::filesystem::path& temporary,
+									   const std::filesystem::path& filename)
+	{
+#if defined(_WIN32)
+		return (MoveFileExW(temporary.c_str(), filename.c_str(),
+							MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0);
+#else
+		return (::rename(temporary.c_str(), filename.c_str()) == 0);
+#endif // _WIN32 end
+	}
+
+	// Makes sure the entries of a directory, like renamed files, reached the disk. On Windows
+	// this is done by renaming with MOVEFILE_WRITE_THROUGH so it does nothing. Returns if it was
+	// successful.
+	inline bool sync_directory([[maybe_unused]] const std::filesystem::path& directory)
+	{
+#if defined(_WIN32)
+		return true;
+#else
+		const int fd = ::open(directory.c_str(), O_RDONLY);
+		if (fd == -1) { return false; } // GCOVR_EXCL_LINE
+		bool success = (::fsync(fd) == 0);
+		if (::close(fd) != 0) { success = false; } // GCOVR_EXCL_LINE
+		return success;
+#endif // _WIN32 end
+	}
+
+} // namespace detail end
+
+
+/// Write data to a file replacing it atomically. The data is written to a temporary file in the
+/// same directory, it is flushed to the disk, then the temporary file is renamed to replace the
+/// file and finally the directory is flushed to the disk. If the program crashes at any point 
+/// the file contains either all of the old data or all of the new data and never anything in
+/// between. The permissions of the file are kept and on Linux / Unix also its owner when
+/// possible. When the file is a symbolic link the file it points to is replaced and the link is
+/// kept. Returns if the file was written successfully, if it wasn't the file is unchanged.
+/// @param[in] filename The relative or absolute path to a file.
+/// @param[in] write_data The data to write to the file.
+/// @return Returns if the file was written successfully.
+inline bool write_file_atomic(const std::filesystem::path& filename, std::string_view write_data)
+{
+	const auto target = mtl::filesystem::detail::resolve_symlink(filename);
+	std::filesystem::path temporary;
+	if (mtl::filesystem::detail::write_durable_temporary(target, write_data, temporary) == false)
+	{
+		return false;
+	}
+
+	if (mtl::filesystem::detail::replace_with_temporary(temporary, target) == false)
+	{
+		std::error_code error_code;
+		std::filesystem::remove(temporary, error_code);
+		return false;
+	}
+
+	const auto directory = mtl::filesystem::detail::parent_directory(target);
+	return mtl::filesystem::detail::sync_directory(directory);
+}
+
+
+/// Write data to many files replacing each one atomically while sharing the cost of making them
+/// durable. All the data is written to temporary files first and flushed to the disk, then all
+/// the temporary files are renamed to replace the files and finally each directory is flushed to
+/// the disk only once, no matter how many files it contains. Each file contains either all of its
+/// old data or all of its new data. If any file can't be written then none of the files are
+/// replaced. If renaming fails midway the files that were already renamed keep their new data.
+/// Permissions, owners and symbolic links are kept the same as mtl::filesystem::write_file_atomic.
+/// The container element type has to be an std::pair of std::filesystem::path and std::string
+/// or std::string_view. Returns if all the files were written successfully.
+/// @param[in] files A container of std::pair with the path of each file and its data.
+/// @return Returns if all the files were written successfully.
+template<typename Container>
+inline bool write_files_atomic(const Container& files)
+{
+	const auto file_count = static_cast<size_t>(std::distance(files.begin(), files.end()));
+	std::vector<std::filesystem::path> targets;
+	std::vector<std::filesystem::path> temporaries;
+	mtl::reserve(targets, file_count);
+	mtl::reserve(temporaries, file_count);
+
+	// removes all the temporary files when something went wrong
+	const auto remove_temporaries = [&temporaries]()
+	{
+		std::error_code error_code;
+		for (const auto& temporary : temporaries)
+		{
+			std::filesystem::remove(temporary, error_code);
+		}
+	};
+
+	// write all the data to temporary files and flush them to the disk
+	for (const auto& [filename, write_data] : files)
+	{
+		auto target = mtl::filesystem::detail::resolve_symlink(filename);
+		std::filesystem::path temporary;
+		if (mtl::filesystem::detail::write_durable_temporary(target, write_data, 
+															 temporary) == false)
+		{
+			remove_temporaries();
+			return false;
+		}
+		targets.emplace_back(std::move(target));
+		temporaries.emplace_back(std::move(temporary));
+	}
+
+	// replace all the files and remember each directory only once
+	std::vector<std::filesystem::path> directories;
+	for (size_t index = 0; index < targets.size(); ++index)
+	{
+		const std::filesystem::path& filename = targets[index];
+		if (mtl::filesystem::detail::replace_with_temporary(temporaries[index], filename) == false)
+		{
+			// the files already renamed can't be restored, remove the rest of the temporaries
+			temporaries.erase(temporaries.begin(), 
+							  std::next(temporaries.begin(), static_cast<std::ptrdiff_t>(index)));
+			remove_temporaries();
+			return false;
+		}
+
+		auto directory = mtl::filesystem::detail::parent_directory(filename);
+		if (std::find(directories.begin(), directories.end(), directory) == directories.end())
+		{
+			directories.emplace_back(std::move(directory));
+		}
+	}
+
+	// flush each directory to the disk once
+	bool success = true;
+	for (const auto& directory : directories)
+	{
+		if (mtl::filesystem::detail::sync_directory(directory) == false) { success = false; }
+	}
+	return success;
+}
+
+
+
+// ================================================================================================
+// LINE_FOLLOWER    - Follows a growing file and reads only the lines appended to it.
+// ================================================================================================
+
+
+/// Follows a file that keeps growing, like a log file, and reads only the complete lines that were
+/// appended since the last read. Remembers the offset it has read up to so each read costs as
+/// much as the new data and not as much as the whole file. Lines are split using the same rules
+/// for LF and CRLF as mtl::filesystem::read_all_lines. A line is only returned when its newline
+/// has been written. When the file is truncated it is read again from the start. On Linux and
+/// Unix when the file is rotated, renamed and replaced by a new file with the same name, the rest
+/// of the old file is read before following the new file. Waiting for new lines uses inotify on
+/// Linux and sleeps between checks on other operating systems. Can be moved but not copied.
+class line_follower : mtl::no_copy
+{
+	// The path of the file we follow.
+	std::filesystem::path _filename;
+	// The offset in the file we have read up to.
+	std::uintmax_t _offset = 0;
+	// Data that was read but doesn't end with a newline yet.
+	std::string _partial;
+	// If a file is being followed.
+	bool _open = false;
+
+#if !defined(_WIN32)
+	// The file descriptor of the file we follow, it stays valid even after the file is renamed.
+	int _fd = -1;
+	// The device of the file we follow.
+	dev_t _device = 0;
+	// The inode of the file we follow.
+	ino_t _inode = 0;
+#endif // _WIN32 end
+
+#if defined(__linux__)
+	// The inotify instance that watches the directory of the file.
+	int _inotify_fd = -1;
+#endif // __linux__ end
+
+	// Opens the file by its path. Returns if it was successful.
+	bool open_file()
+	{
+#if defined(_WIN32)
+		std::error_code error_code;
+		return std::filesystem::is_regular_file(_filename, error_code);
+#else
+		const int fd = ::open(_filename.c_str(), O_RDONLY);
+		if (fd == -1) { return false; }
+		struct stat file_stat {};
+		if (::fstat(fd, &file_stat) != 0)
+		{
+			::close(fd); // GCOVR_EXCL_LINE
+			return false; // GCOVR_EXCL_LINE
+		}
+		close_file();
+		_fd = fd;
+		_device = file_stat.st_dev;
+		_inode = file_stat.st_ino;
+		return true;
+#endif // _WIN32 end
+	}
+
+	// Closes the file.
+	void close_file() noexcept
+	{
+#if !defined(_WIN32)
+		if (_fd != -1) { ::close(_fd); }
+		_fd = -1;
+#endif // _WIN32 end
+	}
+
+	// Returns the current size of the file we follow.
+	[[nodiscard]]
+	std::uintmax_t file_size() const
+	{
+#if defined(_WIN32)
+		std::error_code error_code;
+		const auto size = std::filesystem::file_size(_filename, error_code);
+		if (error_code) { return _offset; }
+		return size;
+#else
+		struct stat file_stat {};
+		if (::fstat(_fd, &file_stat) != 0) { return _offset; } // GCOVR_EXCL_LINE
+		return static_cast<std::uintmax_t>(file_stat.st_size);
+#endif // _WIN32 end
+	}
+
+	// Reads everything from the offset to the end of the file and adds it to the partial data.
+	// Returns if it was successful.
+	bool read_to_end()
+	{
+#if defined(_WIN32)
+		std::ifstream in_file(_filename, std::ios::in | std::ios::binary);
+		if (in_file.is_open() == false) { return false; }
+		in_file.seekg(static_cast<std::streamoff>(_offset));
+		if (in_file.fail()) { return false; } // GCOVR_EXCL_LINE
+		std::array<char, 65536> buffer {};
+		while (in_file)
+		{
+			in_file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+			const auto count = static_cast<size_t>(in_file.gcount());
+			_partial.append(buffer.data(), count);
+			_offset += count;
+		}
+		return true;
+#else
+		std::array<char, 65536> buffer {};
+		while (true)
+		{
+			const ssize_t count = ::pread(_fd, buffer.data(), buffer.size(), 
+										  static_cast<off_t>(_offset));
+			if (count < 0)
+			{
+				if (errno == EINTR) { continue; } // GCOVR_EXCL_LINE
+				return false; // GCOVR_EXCL_LINE
+			}
+			if (count == 0) { return true; }
+			_partial.append(buffer.data(), static_cast<size_t>(count));
+			_offset += static_cast<std::uintmax_t>(count);
+		}
+#endif // _WIN32 end
+	}
+
+	// Moves all the complete lines from the partial data to the container.
+	template<typename Container>
+	void take_complete_lines(Container& read_lines)
+	{
+		const size_t last_newline = _partial.rfind('\n');
+		if (last_newline == std::string::npos) { return; }
+
+		// everything up to and including the last newline consists of complete lines, splitting
+		// it always leaves an empty token at the end that isn't a line
+		const std::string_view complete(_partial.data(), last_newline + 1);
+		mtl::filesystem::detail::specialized_split_crlf(complete, read_lines);
+		read_lines.pop_back();
+		_partial.erase(0, last_newline + 1);
+	}
+
+	// Checks if the file was renamed and replaced by a new file. If it was then it reads the rest
+	// of the old file and starts following the new file. Returns if it was successful.
+	template<typename Container>
+	bool handle_rotation([[maybe_unused]] Container& read_lines)
+	{
+#if !defined(_WIN32)
+		struct stat path_stat {};
+		// the file may be missing for a moment while it is rotated so keep using the old file
+		if (::stat(_filename.c_str(), &path_stat) != 0) { return true; }
+		if ((path_stat.st_dev == _device) && (path_stat.st_ino == _inode)) { return true; }
+
+		// the old file is complete so whatever is left after its last newline is its last line
+		if (read_to_end() == false) { return false; } // GCOVR_EXCL_LINE
+		take_complete_lines(read_lines);
+		if (_partial.empty() == false)
+		{
+			mtl::emplace_back(read_lines, std::string_view(_partial));
+			_partial.clear();
+		}
+
+		if (open_file() == false) { return true; } // GCOVR_EXCL_LINE
+		_offset = 0;
+#endif // _WIN32 end
+		return true;
+	}
+
+	// Waits until the directory of the file changes or the timeout expires.
+	void wait_for_change(const std::chrono::milliseconds timeout, 
+						 const std::chrono::milliseconds poll_interval)
+	{
+#if defined(__linux__)
+		if (_inotify_fd != -1)
+		{
+			pollfd descriptor { _inotify_fd, POLLIN, 0 };
+			const auto milliseconds = static_cast<int>(std::min<std::chrono::milliseconds::rep>(
+				timeout.count(), std::numeric_limits<int>::max()));
+			if (::poll(&descriptor, 1, milliseconds) > 0)
+			{
+				// drain all the events, we only care that something changed
+				std::array<char, 4096> events {};
+				while (::read(_inotify_fd, events.data(), events.size()) > 0) {}
+			}
+			return;
+		}
+#endif // __linux__ end
+		std::this_thread::sleep_for(std::min(timeout, poll_interval));
+	}
+
+public:
+
+	// ============================================================================================
+	// LINE_FOLLOWER - Constructors and destructor.
+	// ============================================================================================
+
+	/// Default constructor that doesn't follow any file.
+	line_follower() = default;
+
+	/// Constructor that starts following a file. Use is_open to check if it was successful.
+	/// @param[in] filename The relative or absolute path to a file.
+	/// @param[in] from_end An optional boolean to skip the lines that already exist in the file.
+	explicit line_follower(const std::filesystem::path& filename, const bool from_end = false)
+	{
+		open(filename, from_end);
+	}
+
+	/// Destructor that stops following the file.
+	~line_follower() { close(); }
+
+	/// Move constructor.
+	line_follower(line_follower&& other) noexcept
+	: _filename(std::move(other._filename)), _offset(other._offset), 
+	  _partial(std::move(other._partial)), _open(other._open)
+	{
+#if !defined(_WIN32)
+		_fd = std::exchange(other._fd, -1);
+		_device = other._device;
+		_inode = other._inode;
+#endif // _WIN32 end
+#if defined(__linux__)
+		_inotify_fd = std::exchange(other._inotify_fd, -1);
+#endif // __linux__ end
+		other._open = false;
+	}
+
+	/// Move assignment operator.
+	line_follower& operator=(line_follower&& other) noexcept
+	{
+		if (this != &other)
+		{
+			close();
+			_filename = std::move(other._filename);
+			_offset = other._offset;
+			_partial = std::move(other._partial);
+			_open = std::exchange(other._open, false);
+#if !defined(_WIN32)
+			_fd = std::exchange(other._fd, -1);
+			_device = other._device;
+			_inode = other._inode;
+#endif // _WIN32 end
+#if defined(__linux__)
+			_inotify_fd = std::exchange(other._inotify_fd, -1);
+#endif // __linux__ end
+		}
+		return *this;
+	}
+
+	// ============================================================================================
+	// OPEN - Starts following a file.
+	// ============================================================================================
+
+	/// Starts following a file. If from_end is true the lines that already exist in the file are
+	/// skipped and only lines appended from now on are read. If another file was already followed
+	/// it stops following it first. Returns if the file was opened successfully.
+	/// @param[in] filename The relative or absolute path to a file.
+	/// @param[in] from_end An optional boolean to skip the lines that already exist in the file.
+	/// @return Returns if the file was opened successfully.
+	bool open(const std::filesystem::path& filename, const bool from_end = false)
+	{
+		close();
+		_filename = filename;
+		if (open_file() == false) { return false; }
+		_offset = from_end ? file_size() : 0;
+		_open = true;
+
+#if defined(__linux__)
+		// watch the directory instead of the file so we also notice when the file is replaced
+		_inotify_fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (_inotify_fd != -1)
+		{
+			const auto directory = mtl::filesystem::detail::parent_directory(_filename);
+			const auto mask = static_cast<std::uint32_t>(IN_MODIFY | IN_CREATE | IN_MOVED_TO | 
+														 IN_MOVED_FROM | IN_DELETE | IN_ATTRIB);
+			if (::inotify_add_watch(_inotify_fd, directory.c_str(), mask) == -1)
+			{
+				// GCOVR_EXCL_START
+				::close(_inotify_fd);
+				_inotify_fd = -1;
+				// GCOVR_EXCL_STOP
+			}
+		}
+#endif // __linux__ end
+
+		return true;
+	}
+
+	// ============================================================================================
+	// CLOSE - Stops following the file.
+	// ============================================================================================
+
+	/// Stops following the file. Any incomplete line that was read is discarded.
+	void close() noexcept
+	{
+		close_file();
+#if defined(__linux__)
+		if (_inotify_fd != -1) { ::close(_inotify_fd); }
+		_inotify_fd = -1;
+#endif // __linux__ end
+		_partial.clear();
+		_offset = 0;
+		_open = false;
+	}
+
+	// ============================================================================================
+	// IS_OPEN - Returns if a file is being followed.
+	// ============================================================================================
+
+	/// Returns if a file is being followed.
+	/// @return If a file is being followed.
+	[[nodiscard]]
+	bool is_open() const noexcept { return _open; }
+
+	// ============================================================================================
+	// READ_NEW_LINES - Reads the lines appended since the last read.
+	// ============================================================================================
+
+	/// Reads all the complete lines that were appended to the file since the last read and adds
+	/// them to the container. Doesn't wait if there are no new lines. The container element type
+	/// has to be std::string. Returns if the file was read successfully.
+	/// @param[out] read_lines A container with element type std::string to store the read lines.
+	/// @return Returns if the file was read successfully.
+	template<typename Container>
+	bool read_new_lines(Container& read_lines)
+	{
+		if (_open == false) { return false; }
+		if (handle_rotation(read_lines) == false) { return false; } // GCOVR_EXCL_LINE
+
+		// the file was truncated so start reading it from the beginning
+		if (file_size() < _offset)
+		{
+			_offset = 0;
+			_partial.clear();
+		}
+
+		if (read_to_end() == false) { return false; } // GCOVR_EXCL_LINE
+		take_complete_lines(read_lines);
+		return true;
+	}
+
+	// ============================================================================================
+	// WAIT_NEW_LINES - Waits for new lines to be appended and reads them.
+	// ============================================================================================
+
+	/// Waits until new complete lines are appended to the file or the timeout expires and adds
+	/// them to the container. On Linux it uses inotify to wake up as soon as the file changes, on
+	/// other operating systems it checks the file every poll_interval. The container element type
+	/// has to be std::string. Returns if the file was read successfully.
+	/// @param[out] read_lines A container with element type std::string to store the read lines.
+	/// @param[in] timeout The maximum time to wait for new lines.
+	/// @param[in] poll_interval An optional time between checks when inotify isn't available.
+	/// @return Returns if the file was read successfully.
+	template<typename Container>
+	bool wait_new_lines(Container& read_lines, const std::chrono::milliseconds timeout,
+						const std::chrono::milliseconds poll_interval = 
+						std::chrono::milliseconds(100))
+	{
+		const auto deadline = std::chrono::steady_clock::now() + timeout;
+		const auto original_size = read_lines.size();
+		while (true)
+		{
+			if (read_new_lines(read_lines) == false) { return false; }
+			if (read_lines.size() != original_size) { return true; }
+
+			const auto now = std::chrono::steady_clock::now();
+			if (now >= deadline) { return true; }
+			const auto remaining = 
+				std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now);
+			wait_for_change(remaining + std::chrono::milliseconds(1), poll_interval);
+		}
+	}
+};
+
+
+
+// ================================================================================================
+// LINE_INDEX       - Index of the lines of a file that gives access to any line in constant time.
+// ================================================================================================
+
+
+/// Index of the lines of a file that gives access to any line in constant time without reading
+/// all the lines. The file is memory-mapped and scanned once using the same rules for LF and CRLF
+/// as mtl::filesystem::read_all_lines, so line n is exactly the same as the element n produced by
+/// mtl::filesystem::read_all_lines. The offsets where lines start are stored compactly in blocks,
+/// each block stores the full offset of its first line and 32 bit offsets for the rest of its
+/// lines relative to the first one. The index can be saved to a separate index file so later
+/// opens of the same file don't have to scan it again. Can be moved but not copied.
+class line_index : mtl::no_copy
+{
+	// The number of lines in each block.
+	static constexpr size_t block_size = 64;
+	// Identifies a saved index file and the version of its format.
+	static constexpr std::string_view magic = "MTLLIDX1";
+
+	// The path of the file the lines are in.
+	std::filesystem::path _filename;
+	// The file the lines are in.
+	mtl::filesystem::mapped_file _mapped;
+	// The offset of the first line of each block.
+	std::vector<std::uint64_t> _block_offsets;
+	// The offset of each line relative to the first line of its block.
+	std::vector<std::uint32_t> _line_offsets;
+	// The offset of each line when the lines are too long for 32 bit relative offsets.
+	std::vector<std::uint64_t> _wide_offsets;
+	// The number of lines.
+	size_t _count = 0;
+	// If the last line ends with a newline.
+	bool _last_terminated = false;
+	// If the offsets are stored in _wide_offsets.
+	bool _wide = false;
+
+	// Adds the offset where a line starts.
+	void add_line(const std::uint64_t offset)
+	{
+		if (_wide)
+		{
+			_wide_offsets.push_back(offset);
+			++_count;
+			return;
+		}
+
+		if ((_count % block_size) == 0) { _block_offsets.push_back(offset); }
+		const std::uint64_t relative = offset - _block_offsets.back();
+
+		// a block is too long for 32 bit relative offsets so store full offsets from now on
+		if (relative > std::numeric_limits<std::uint32_t>::max())
+		{
+			_wide_offsets.reserve(_count + 1);
+			for (size_t i = 0; i < _count; ++i) { _wide_offsets.push_back(line_start(i)); }
+			_block_offsets.clear();
+			_line_offsets.clear();
+			_wide = true;
+			_wide_offsets.push_back(offset);
+			++_count;
+			return;
+		}
+
+		_line_offsets.push_back(static_cast<std::uint32_t>(relative));
+		++_count;
+	}
+
+	// Returns the offset where a line starts.
+	[[nodiscard]]
+	std::uint64_t line_start(const size_t index) const noexcept
+	{
+		if (_wide) { return _wide_offsets[index]; }
+		return _block_offsets[index / block_size] + _line_offsets[index];
+	}
+
+	// Scans the mapped file and finds where each line starts.
+	void scan()
+	{
+		const std::string_view contents = _mapped.view();
+		std::uint64_t current_start = 0;
+		mtl::string::detail::find_all_chars(contents, '\n', [&](const size_t match_pos)
+		{
+			add_line(current_start);
+			current_start = match_pos + 1;
+		});
+
+		// the text after the last newline is a line only if it isn't empty
+		if (current_start < contents.size())
+		{
+			add_line(current_start);
+			_last_terminated = false;
+		}
+		else
+		{
+			_last_terminated = (_count > 0);
+		}
+	}
+
+	// Returns the size and modification time of a file used to check a saved index belongs to
+	// the file as it is now.
+	[[nodiscard]]
+	static bool file_identity(const std::filesystem::path& filename, std::uint64_t& size,
+							  std::int64_t& time)
+	{
+		std::error_code error_code;
+		size = static_cast<std::uint64_t>(std::filesystem::file_size(filename, error_code));
+		if (error_code) { return false; }
+		const auto write_time = std::filesystem::last_write_time(filename, error_code);
+		if (error_code) { return false; }
+		time = static_cast<std::int64_t>(write_time.time_since_epoch().count());
+		return true;
+	}
+
+	// Appends the bytes of a value to a buffer.
+	template<typename Type>
+	static void append_value(std::string& buffer, const Type& value)
+	{
+		buffer.append(reinterpret_cast<const char*>(&value), sizeof(Type));
+	}
+
+	// Reads the bytes of a value from a buffer and moves the buffer forward. Returns false if the
+	// buffer is too small.
+	template<typename Type>
+	static bool read_value(std::string_view& buffer, Type& value)
+	{
+		if (buffer.size() < sizeof(Type)) { return false; }
+		std::memcpy(&value, buffer.data(), sizeof(Type));
+		buffer.remove_prefix(sizeof(Type));
+		return true;
+	}
+
+	// Reads an array of values from a buffer and moves the buffer forward. Returns false if the
+	// buffer is too small.
+	template<typename Type>
+	static bool read_array(std::string_view& buffer, std::vector<Type>& values, const size_t count)
+	{
+		if ((buffer.size() / sizeof(Type)) < count) { return false; }
+		values.resize(count);
+		if (count > 0) { std::memcpy(values.data(), buffer.data(), count * sizeof(Type)); }
+		buffer.remove_prefix(count * sizeof(Type));
+		return true;
+	}
+
+	// Loads a saved index. Returns false if the index is missing, damaged or belongs to a 
+	// different version of the file, in which case no offsets are kept so the file can be
+	// scanned again.
+	bool load(const std::filesystem::path& filename, const std::filesystem::path& index_filename)
+	{
+		std::error_code error_code;
+		if (std::filesystem::is_regular_file(index_filename, error_code) == false) { return false; }
+
+		mtl::filesystem::mapped_file saved(index_filename);
+		if (saved.is_open() == false) { return false; }
+		std::string_view buffer = saved.view();
+
+		std::uint64_t size = 0;
+		std::int64_t time = 0;
+		if (file_identity(filename, size, time) == false) { return false; }
+
+		if (buffer.substr(0, magic.size()) != magic) { return false; }
+		buffer.remove_prefix(magic.size());
+
+		std::uint64_t saved_size = 0;
+		std::int64_t saved_time = 0;
+		std::uint64_t count = 0;
+		std::uint8_t last_terminated = 0;
+		std::uint8_t wide = 0;
+		if ((read_value(buffer, saved_size) && read_value(buffer, saved_time) &&
+			 read_value(buffer, count) && read_value(buffer, last_terminated) &&
+			 read_value(buffer, wide)) == false)
+		{
+			return false;
+		}
+		if ((saved_size != size) || (saved_time != time) || (size != _mapped.size()))
+		{
+			return false;
+		}
+		if (count > std::numeric_limits<size_t>::max()) { return false; } // GCOVR_EXCL_LINE
+
+		_count = static_cast<size_t>(count);
+		_last_terminated = (last_terminated != 0);
+		_wide = (wide != 0);
+		bool success = false;
+		if (_wide)
+		{
+			success = read_array(buffer, _wide_offsets, _count);
+		}
+		else
+		{
+			const size_t blocks = (_count + block_size - 1) / block_size;
+			success = read_array(buffer, _block_offsets, blocks) &&
+					  read_array(buffer, _line_offsets, _count);
+		}
+
+		// a damaged index can't be used because the offsets are used without checks later
+		if (success) { success = valid_offsets(); }
+		if (success == false) { clear_index(); }
+		return success;
+	}
+
+	// Returns if the offsets loaded from an index file can belong to the mapped file. Every line
+	// has to start after the previous one and inside the file, and the first line has to start at
+	// the beginning of the file, otherwise the ends of the lines can come before their starts.
+	[[nodiscard]]
+	bool valid_offsets() const noexcept
+	{
+		const auto file_size = static_cast<std::uint64_t>(_mapped.size());
+		// only an empty file has no lines and a newline can't end an empty file
+		if ((_count == 0) != (file_size == 0)) { return false; }
+		if (_last_terminated && (_count == 0)) { return false; }
+
+		if (_wide == false)
+		{
+			std::uint64_t previous_block = 0;
+			for (const std::uint64_t offset : _block_offsets)
+			{
+				if ((offset < previous_block) || (offset >= file_size)) { return false; }
+				previous_block = offset;
+			}
+		}
+
+		std::uint64_t previous = 0;
+		for (size_t i = 0; i < _count; ++i)
+		{
+			std::uint64_t offset = 0;
+			if (_wide)
+			{
+				offset = _wide_offsets[i];
+			}
+			else
+			{
+				const std::uint64_t block_offset = _block_offsets[i / block_size];
+				// checked before adding so a damaged relative offset can't overflow
+				if (_line_offsets[i] >= file_size - block_offset) { return false; }
+				offset = block_offset + _line_offsets[i];
+			}
+
+			if (offset >= file_size) { return false; }
+			if ((i == 0) && (offset != 0)) { return false; }
+			if ((i > 0) && (offset <= previous)) { return false; }
+			previous = offset;
+		}
+		return true;
+	}
+
+	// Removes all the offsets.
+	void clear_index() noexcept
+	{
+		_block_offsets.clear();
+		_line_offsets.clear();
+		_wide_offsets.clear();
+		_count = 0;
+		_last_terminated = false;
+		_wide = false;
+	}
+
+public:
+
+	// ============================================================================================
+	// OPEN - Opens a file and indexes its lines.
+	// ============================================================================================
+
+	/// Opens a file and indexes its lines by scanning the whole file once. If another file was
+	/// already open it is closed first. Returns if the file was indexed successfully.
+	/// @param[in] filename The relative or absolute path to a file.
+	/// @return Returns if the file was indexed successfully.
+	bool open(const std::filesystem::path& filename)
+	{
+		close();
+		if (mtl::filesystem::read_file(filename, _mapped) == false) { return false; }
+		_filename = filename;
+		scan();
+		return true;
+	}
+
+	/// Opens a file and loads the index of its lines from an index file. If the index file doesn't
+	/// exist or was saved for a different version of the file then the file is scanned and the
+	/// index file is saved again. If another file was already open it is closed first. Returns if
+	/// the file was indexed successfully.
+	/// @param[in] filename The relative or absolute path to a file.
+	/// @param[in] index_filename The relative or absolute path to the index file.
+	/// @return Returns if the file was indexed successfully.
+	bool open(const std::filesystem::path& filename, const std::filesystem::path& index_filename)
+	{
+		close();
+		if (mtl::filesystem::read_file(filename, _mapped) == false) { return false; }
+		_filename = filename;
+		if (load(filename, index_filename)) { return true; }
+		scan();
+		// failing to save the index doesn't stop us from using it
+		save(index_filename);
+		return true;
+	}
+
+	// ============================================================================================
+	// SAVE - Saves the index to an index file.
+	// ============================================================================================
+
+	/// Saves the index to an index file so it can be loaded by open without scanning the file 
+	/// again. The index file is stored in the native byte order and is replaced atomically. 
+	/// Returns if the index was saved successfully.
+	/// @param[in] index_filename The relative or absolute path to the index file.
+	/// @return Returns if the index was saved successfully.
+	bool save(const std::filesystem::path& index_filename) const
+	{
+		if (_mapped.is_open() == false) { return false; }
+
+		std::uint64_t size = 0;
+		std::int64_t time = 0;
+		if (file_identity(_filename, size, time) == false) { return false; }
+
+		std::string buffer;
+		buffer.reserve(64 + (_block_offsets.size() * sizeof(std::uint64_t)) +
+					   (_line_offsets.size() * sizeof(std::uint32_t)) +
+					   (_wide_offsets.size() * sizeof(std::uint64_t)));
+		buffer.append(magic);
+		append_value(buffer, size);
+		append_value(buffer, time);
+		append_value(buffer, static_cast<std::uint64_t>(_count));
+		append_value(buffer, static_cast<std::uint8_t>(_last_terminated ? 1 : 0));
+		append_value(buffer, static_cast<std::uint8_t>(_wide ? 1 : 0));
+		for (const auto offset : _wide_offsets) { append_value(buffer, offset); }
+		for (const auto offset : _block_offsets) { append_value(buffer, offset); }
+		for (const auto offset : _line_offsets) { append_value(buffer, offset); }
+
+		return mtl::filesystem::write_file_atomic(index_filename, buffer);
+	}
+
+	// ============================================================================================
+	// CLOSE - Closes the file and removes the index.
+	// ============================================================================================
+
+	/// Closes the file and removes the index.
+	void close() noexcept
+	{
+		clear_index();
+		_mapped.close();
+		_filename.clear();
+	}
+
+	// ============================================================================================
+	// SIZE, EMPTY - Returns the number of lines.
+	// ============================================================================================
+
+	/// Returns the number of lines.
+	/// @return The number of lines.
+	[[nodiscard]]
+	size_t size() const noexcept { return _count; }
+
+	/// Returns if there are no lines.
+	/// @return If there are no lines.
+	[[nodiscard]]
+	bool empty() const noexcept { return (_count == 0); }
+
+	// ============================================================================================
+	// LINE, OPERATOR[] - Returns a line.
+	// ============================================================================================
+
+	/// Returns the line at the given index without bounds checking. The line is valid for as
+	/// long as the file is open.
+	/// @param[in] index The index of the line.
+	/// @return An std::string_view of the line.
+	[[nodiscard]]
+	std::string_view operator[](const size_t index) const noexcept
+	{
+		const char* data = _mapped.data();
+		const auto start = static_cast<size_t>(line_start(index));
+		size_t end = 0;
+		// lines that end with a newline may also end with a carriage return
+		if ((index + 1 < _count) || _last_terminated)
+		{
+			end = (index + 1 < _count) ? static_cast<size_t>(line_start(index + 1)) - 1
+									   : _mapped.size() - 1;
+			if ((end > start) && (data[end - 1] == '\r')) { --end; }
+		}
+		// the last line that doesn't end with a newline
+		else
+		{
+			end = _mapped.size();
+		}
+		return std::string_view(data + start, end - start);
+	}
+
+	/// Returns the line at the given index. Throws std::out_of_range if the index is out of
+	/// range. The line is valid for as long as the file is open.
+	/// @param[in] index The index of the line.
+	/// @return An std::string_view of the line.
+	[[nodiscard]]
+	std::string_view line(const size_t index) const
+	{
+		if (index >= _count)
+		{
+			throw std::out_of_range("The line index is out of range.");
+		}
+		return (*this)[index];
+	}
+};
+
+
+
+// ================================================================================================
+// TREE_ENTRY       - Information about a file or directory found by scan_tree.
+// ================================================================================================
+
+/// Information about a file or directory found by mtl::filesystem::scan_tree.
+struct tree_entry
+{
+	/// The path of the file or directory, it starts with the directory that was scanned.
+	std::filesystem::path path;
+	/// The size of the file in bytes. It is 0 for directories.
+	std::uintmax_t size = 0;
+	/// The time the file was last modified in nanoseconds since 1 January 1970 UTC.
+	std::int64_t last_write_time = 0;
+	/// If the entry is a directory.
+	bool is_directory = false;
+};
+
+// ================================================================================================
+// SCAN_TREE        - Scans a directory and all its subdirectories using multiple threads.
+// ================================================================================================
+
+namespace detail
+{
+
+	// Closes an open directory when the object is destroyed, so it is also closed when adding an
+	// entry throws. On Linux and Unix it closes the file descriptor or the directory stream that
+	// took it over and on Windows it closes the handle of the directory search.
+	class directory_closer : mtl::no_move
+	{
+#if defined(_WIN32)
+		HANDLE _handle = INVALID_HANDLE_VALUE;
+#else
+		int _fd = -1;
+		DIR* _stream = nullptr;
+#endif // _WIN32 end
+
+	public:
+
+#if defined(_WIN32)
+		explicit directory_closer(HANDLE handle) noexcept : _handle(handle) {}
+#else
+		explicit directory_closer(const int fd) noexcept : _fd(fd) {}
+#endif // _WIN32 end
+
+		~directory_closer()
+		{
+#if defined(_WIN32)
+			if (_handle != INVALID_HANDLE_VALUE) { FindClose(_handle); }
+#else
+			// closing the stream also closes the file descriptor
+			if (_stream != nullptr) { ::closedir(_stream); }
+			else if (_fd != -1) { ::close(_fd); }
+#endif // _WIN32 end
+		}
+
+#if !defined(_WIN32)
+		// The directory stream took over the file descriptor so the stream is closed instead.
+		void set_stream(DIR* stream) noexcept { _stream = stream; }
+#endif // _WIN32 end
+	};
+
+#if defined(_WIN32)
+
+	// Reads all the entries of a single directory. The entries are added to the entries and the
+	// subdirectories are added to the subdirectories so they can be scanned later.
+	inline void scan_directory(const std::filesystem::path& directory, 
+							   std::vector<tree_entry>& entries,
+							   std::vector<std::filesystem::path>& subdirectories)
+	{
+		// FILETIME counts 100 nanosecond intervals since 1 January 1601
+		constexpr std::int64_t epoch_difference = 116444736000000000;
+
+		const std::wstring pattern = (directory / L"*").wstring();
+		WIN32_FIND_DATAW data {};
+		HANDLE find_handle = FindFirstFileExW(pattern.c_str(), FindExInfoBasic, &data, 
+											  FindExSearchNameMatch, nullptr, 
+											  FIND_FIRST_EX_LARGE_FETCH);
+		if (find_handle == INVALID_HANDLE_VALUE) { return; }
+		const mtl::filesystem::detail::directory_closer closer(find_handle);
+
+		do
+		{
+			const std::wstring_view name(data.cFileName);
+			if ((name == L".") || (name == L"..")) { continue; }
+
+			tree_entry entry;
+			entry.path = directory / name;
+			entry.is_directory = (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+			if (entry.is_directory == false)
+			{
+				entry.size = (static_cast<std::uintmax_t>(data.nFileSizeHigh) << 32) | 
+							 data.nFileSizeLow;
+			}
+			const std::int64_t file_time = 
+				(static_cast<std::int64_t>(data.ftLastWriteTime.dwHighDateTime) << 32) | 
+				data.ftLastWriteTime.dwLowDateTime;
+			entry.last_write_time = (file_time - epoch_difference) * 100;
+
+			// don't follow symbolic links and junctions to directories
+			const bool reparse_point = (data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) != 0;
+			if (entry.is_directory && (reparse_point == false)) 
+			{
+				subdirectories.push_back(entry.path); 
+			}
+			entries.push_back(std::move(entry));
+		}
+		while (FindNextFileW(find_handle, &data) != 0);
+	}
+
+#else
+
+	// Gets the information about an entry of a directory without following symbolic links. 
+	// Returns if it was successful.
+	inline bool stat_entry(const int directory_fd, const char* name, tree_entry& entry)
+	{
+#if defined(__linux__) && defined(STATX_BASIC_STATS)
+		struct statx file_stat {};
+		const unsigned int mask = STATX_TYPE | STATX_SIZE | STATX_MTIME;
+		if (::statx(directory_fd, name, AT_SYMLINK_NOFOLLOW | AT_NO_AUTOMOUNT, mask, 
+					&file_stat) != 0)
+		{
+			return false;
+		}
+		entry.is_directory = S_ISDIR(file_stat.stx_mode);
+		entry.size = entry.is_directory ? 0 : static_cast<std::uintmax_t>(file_stat.stx_size);
+		entry.last_write_time = static_cast<std::int64_t>(file_stat.stx_mtime.tv_sec) * 
+								1000000000 + file_stat.stx_mtime.tv_nsec;
+#else
+		struct stat file_stat {};
+		if (::fstatat(directory_fd, name, &file_stat, AT_SYMLINK_NOFOLLOW) != 0) { return false; }
+		entry.is_directory = S_ISDIR(file_stat.st_mode);
+		entry.size = entry.is_directory ? 0 : static_cast<std::uintmax_t>(file_stat.st_size);
+#if defined(__APPLE__)
+		const auto& modified = file_stat.st_mtimespec;
+#else
+		const auto& modified = file_stat.st_mtim;
+#endif // __APPLE__ end
+		entry.last_write_time = static_cast<std::int64_t>(modified.tv_sec) * 1000000000 + 
+								modified.tv_nsec;
+#endif // __linux__ and STATX_BASIC_STATS end
+		return true;
+	}
+
+	// Adds an entry of a directory to the entries and if it is a directory to the subdirectories.
+	inline void add_tree_entry(const std::filesystem::path& directory, const int directory_fd,
+							   const char* name, std::vector<tree_entry>& entries,
+							   std::vector<std::filesystem::path>& subdirectories)
+	{
+		if ((name[0] == '.') && ((name[1] == '\0') || ((name[1] == '.') && (name[2] == '\0'))))
+		{
+			return;
+		}
+
+		tree_entry entry;
+		// the entry may have been removed since the directory was read
+		if (stat_entry(directory_fd, name, entry) == false) { return; }
+		entry.path = directory / name;
+		if (entry.is_directory) { subdirectories.push_back(entry.path); }
+		entries.push_back(std::move(entry));
+	}
+
+	// Reads all the entries of a single directory. The entries are added to the entries and the
+	// subdirectories are added to the subdirectories so they can be scanned later.
+	inline void scan_directory(const std::filesystem::path& directory, 
+							   std::vector<tree_entry>& entries,
+							   std::vector<std::filesystem::path>& subdirectories)
+	{
+		const int directory_fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+		if (directory_fd == -1) { return; }
+		mtl::filesystem::detail::directory_closer closer(directory_fd);
+
+#if defined(__linux__) && defined(SYS_getdents64)
+		// read many entries with a single system call, each record of the buffer is a 
+		// linux_dirent64 with the record length at offset 16 and the name at offset 19
+		constexpr size_t reclen_offset = 16;
+		constexpr size_t name_offset = 19;
+		std::vector<char> buffer(64 * 1024);
+		while (true)
+		{
+			const long count = ::syscall(SYS_getdents64, directory_fd, buffer.data(), 
+										 buffer.size());
+			if (count <= 0) { break; }
+			size_t position = 0;
+			while (position < static_cast<size_t>(count))
+			{
+				unsigned short record_length = 0;
+				std::memcpy(&record_length, buffer.data() + position + reclen_offset, 
+							sizeof(record_length));
+				const char* name = buffer.data() + position + name_offset;
+				add_tree_entry(directory, directory_fd, name, entries, subdirectories);
+				position += record_length;
+			}
+		}
+#else
+		DIR* directory_stream = ::fdopendir(directory_fd);
+		if (directory_stream == nullptr) { return; } // GCOVR_EXCL_LINE
+		closer.set_stream(directory_stream);
+		while (const dirent* directory_entry = ::readdir(directory_stream))
+		{
+			add_tree_entry(directory, directory_fd, directory_entry->d_name, entries, 
+						   subdirectories);
+		}
+#endif // __linux__ and SYS_getdents64 end
+	}
+
+#endif // _WIN32 end
+
+} // namespace detail end
+
+
+/// Scans a directory and all its subdirectories and stores information about every file and
+/// directory found to the given vector. Directories are scanned in parallel by a pool of threads
+/// that share a queue of directories that are waiting to be scanned. On Linux each directory is
+/// read in large batches with getdents64 and entries are examined with statx. Symbolic links are
+/// reported but not followed. Directories that can't be read are skipped. The entries are in no
+/// particular order. A thread_count of 0 uses as many threads as the hardware supports. Returns
+/// if the given path is a directory that could be scanned.
+/// @param[in] directory The relative or absolute path to a directory.
+/// @param[out] entries A vector of mtl::filesystem::tree_entry to store the entries found.
+/// @param[in] thread_count An optional number of threads to use.
+/// @return Returns if the directory was scanned successfully.
+inline bool scan_tree(const std::filesystem::path& directory, std::vector<tree_entry>& entries,
+					  size_t thread_count = 0)
+{
+	std::error_code error_code;
+	if (std::filesystem::is_directory(directory, error_code) == false) { return false; }
+
+	if (thread_count == 0) { thread_count = std::thread::hardware_concurrency(); }
+	if (thread_count == 0) { thread_count = 1; } // GCOVR_EXCL_LINE
+
+	// the directories waiting to be scanned and how many threads are scanning a directory, when
+	// there are no directories waiting and no thread is scanning then the whole tree is done
+	std::mutex queue_mutex;
+	std::condition_variable queue_changed;
+	std::vector<std::filesystem::path> pending { directory };
+	size_t active = 0;
+
+	// each thread keeps its own entries so the threads don't compete for a lock for every entry
+	std::vector<std::vector<tree_entry>> thread_entries(thread_count);
+	std::vector<std::exception_ptr> errors(thread_count);
+
+	auto worker = [&](const size_t index)
+	{
+		std::vector<std::filesystem::path> subdirectories;
+		while (true)
+		{
+			std::filesystem::path current;
+			{
+				std::unique_lock<std::mutex> lock(queue_mutex);
+				queue_changed.wait(lock, [&]() { return (pending.empty() == false) || 
+														(active == 0); });
+				if (pending.empty()) { return; }
+				current = std::move(pending.back());
+				pending.pop_back();
+				++active;
+			}
+
+			subdirectories.clear();
+			try
+			{
+				mtl::filesystem::detail::scan_directory(current, thread_entries[index], 
+														subdirectories);
+			}
+			catch (...)
+			{
+				errors[index] = std::current_exception();
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(queue_mutex);
+				for (auto& subdirectory : subdirectories) 
+				{
+					pending.push_back(std::move(subdirectory)); 
+				}
+				--active;
+			}
+			queue_changed.notify_all();
+		}
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve(thread_count - 1);
+	for (size_t i = 1; i < thread_count; ++i)
+	{
+		// if no more threads can be started the directories are scanned by the ones running
+		try
+		{
+			threads.emplace_back(worker, i);
+		}
+		// GCOVR_EXCL_START
+		catch (const std::system_error&)
+		{
+			break;
+		}
+		// GCOVR_EXCL_STOP
+	}
+	// the calling thread also scans directories
+	worker(0);
+	for (auto& thread : threads) { thread.join(); }
+
+	// if any of the threads failed rethrow the exception
+	for (const auto& error : errors)
+	{
+		if (error) { std::rethrow_exception(error); }
+	}
+
+	// move all the entries to a single vector
+	size_t total_size = entries.size();
+	for (const auto& current_entries : thread_entries) { total_size += current_entries.size(); }
+	entries.reserve(total_size);
+	for (auto& current_entries : thread_entries)
+	{
+		std::move(current_entries.begin(), current_entries.end(), std::back_inserter(entries));
+	}
+
 	return true;
 }
 
 
 
 // ================================================================================================
-// WRITE_ALL_LINES  - Writes all elements of a container to a file.
+// HASH_FILE        - Computes a fast non-cryptographic hash of the contents of a file.
 // ================================================================================================
 
+/// A 128 bit hash value.
+struct hash128
+{
+	/// The low 64 bits of the hash.
+	std::uint64_t low = 0;
+	/// The high 64 bits of the hash.
+	std::uint64_t high = 0;
+};
 
-/// Write a range to new lines in a file. The filename is used to specify which file to write. The
-/// elements in the range from first to last will be written to the file. Append if set to true
-/// adds to the end of the file instead of overwriting it. Returns if the file was written
-/// successfully.
-/// @param[in] filename The relative or absolute path to a file.
-/// @param[in] first An iterator to the start of a range. Element type can be any type convertible
-///                  to std::string by mtl::string::to_string.
-/// @param[in] last An iterator to the end of a range.
-/// @param[in] append An optional boolean to and append to the end of the file or overwrite it.
-/// @return Returns if all the lines were written successfully.
-template<typename Iter>
-inline bool write_all_lines(const std::filesystem::path& filename, Iter first, Iter last,
-					 		const bool append = false)
+/// Returns if two 128 bit hash values are equal.
+[[nodiscard]]
+inline bool operator==(const hash128& lhs, const hash128& rhs) noexcept
 {
-	std::string internal_buffer;
-	
-	// join all the elements with \n as a delimiter to an internal_buffer
-	mtl::string::join_all(first, last, internal_buffer, '\n');
+	return (lhs.low == rhs.low) && (lhs.high == rhs.high);
+}
 
-	if (internal_buffer.empty() == false)
+/// Returns if two 128 bit hash values are not equal.
+[[nodiscard]]
+inline bool operator!=(const hash128& lhs, const hash128& rhs) noexcept
+{
+	return !(lhs == rhs);
+}
+
+/// The result of hashing a single file with mtl::filesystem::hash_files.
+struct file_hash
+{
+	/// The 128 bit hash of the contents of the file.
+	hash128 hash;
+	/// If the file was read successfully, if it is false the hash is not valid.
+	bool success = false;
+};
+
+namespace detail
+{
+	// The hash is built the same way as XXH3 for long inputs. The input is divided in stripes of
+	// 64 bytes that are accumulated in 8 lanes of 64 bits, after every block of stripes the
+	// accumulators are scrambled and at the end they are merged to a single value. The stripe
+	// accumulation maps directly to SSE2 and AVX2 instructions. The values don't match the
+	// values of XXH3 but they are the same on every platform.
+
+	constexpr std::uint64_t hash_prime32_1 = 0x9E3779B1U;
+	constexpr std::uint64_t hash_prime32_2 = 0x85EBCA77U;
+	constexpr std::uint64_t hash_prime32_3 = 0xC2B2AE3DU;
+	constexpr std::uint64_t hash_prime64_1 = 0x9E3779B185EBCA87ULL;
+	constexpr std::uint64_t hash_prime64_2 = 0xC2B2AE3D27D4EB4FULL;
+	constexpr std::uint64_t hash_prime64_3 = 0x165667B19E3779F9ULL;
+	constexpr std::uint64_t hash_prime64_4 = 0x85EBCA77C2B2AE63ULL;
+	constexpr std::uint64_t hash_prime64_5 = 0x27D4EB2F165667C5ULL;
+
+	// The size of a stripe in bytes.
+	constexpr size_t hash_stripe_size = 64;
+	// The number of 64 bit words of the secret.
+	constexpr size_t hash_secret_words = 24;
+	// Each stripe of a block uses the secret starting one word later than the previous stripe.
+	constexpr size_t hash_stripes_per_block = hash_secret_words - 8;
+
+	// Creates the secret that is mixed with the input using the splitmix64 sequence.
+	constexpr std::array<std::uint64_t, hash_secret_words> make_hash_secret() noexcept
 	{
-		internal_buffer.push_back('\n');
+		std::array<std::uint64_t, hash_secret_words> secret {};
+		std::uint64_t state = 0;
+		for (size_t i = 0; i < secret.size(); ++i)
+		{
+			state += 0x9E3779B97F4A7C15ULL;
+			std::uint64_t value = state;
+			value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+			secret[i] = value ^ (value >> 31);
+		}
+		return secret;
 	}
 
-	// write to file
-	return mtl::filesystem::write_file(filename, internal_buffer, append);
+	inline constexpr std::array<std::uint64_t, hash_secret_words> hash_secret = 
+		make_hash_secret();
+
+	// Reads 64 bits in little endian order.
+	[[nodiscard]]
+	inline std::uint64_t read_little_endian64(const char* data) noexcept
+	{
+		std::uint64_t value = 0;
+		std::memcpy(&value, data, sizeof(value));
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+		value = __builtin_bswap64(value);
+#endif // __BYTE_ORDER__ end
+		return value;
+	}
+
+	// Multiplies two 64 bit values to a 128 bit value and returns the low 64 bits xor the high
+	// 64 bits.
+	[[nodiscard]]
+	inline std::uint64_t multiply_fold64(const std::uint64_t lhs, const std::uint64_t rhs) noexcept
+	{
+#if defined(__SIZEOF_INT128__)
+		__extension__ typedef unsigned __int128 uint128_type;
+		const auto product = static_cast<uint128_type>(lhs) * rhs;
+		return static_cast<std::uint64_t>(product) ^ static_cast<std::uint64_t>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+		std::uint64_t high = 0;
+		const std::uint64_t low = _umul128(lhs, rhs, &high);
+		return low ^ high;
+#else
+		// multiply the 32 bit halves and add the partial products
+		const std::uint64_t lo_lo = (lhs & 0xFFFFFFFF) * (rhs & 0xFFFFFFFF);
+		const std::uint64_t hi_lo = (lhs >> 32) * (rhs & 0xFFFFFFFF);
+		const std::uint64_t lo_hi = (lhs & 0xFFFFFFFF) * (rhs >> 32);
+		const std::uint64_t hi_hi = (lhs >> 32) * (rhs >> 32);
+		const std::uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+		const std::uint64_t high = hi_hi + (hi_lo >> 32) + (cross >> 32);
+		const std::uint64_t low = (cross << 32) | (lo_lo & 0xFFFFFFFF);
+		return low ^ high;
+#endif // __SIZEOF_INT128__ end
+	}
+
+	// Mixes the bits of the hash so every input bit affects every output bit.
+	[[nodiscard]]
+	inline std::uint64_t hash_avalanche(std::uint64_t hash) noexcept
+	{
+		hash ^= hash >> 37;
+		hash *= 0x165667919E3779F9ULL;
+		hash ^= hash >> 32;
+		return hash;
+	}
+
+	// Accumulates the given number of stripes and scrambles the accumulators at the end of every
+	// block. The stripe is the index of the next stripe inside the current block and is updated.
+	inline void hash_accumulate_scalar(std::uint64_t* accumulators, const char* data, 
+									   const size_t stripe_count, size_t& stripe) noexcept
+	{
+		for (size_t s = 0; s < stripe_count; ++s)
+		{
+			const char* stripe_data = data + s * hash_stripe_size;
+			for (size_t i = 0; i < 8; ++i)
+			{
+				const std::uint64_t data_value = read_little_endian64(stripe_data + i * 8);
+				const std::uint64_t data_key = data_value ^ hash_secret[stripe + i];
+				accumulators[i ^ 1] += data_value;
+				accumulators[i] += (data_key & 0xFFFFFFFF) * (data_key >> 32);
+			}
+
+			if (++stripe == hash_stripes_per_block)
+			{
+				for (size_t i = 0; i < 8; ++i)
+				{
+					std::uint64_t value = accumulators[i];
+					value ^= value >> 47;
+					value ^= hash_secret[hash_stripes_per_block + i];
+					accumulators[i] = value * hash_prime32_1;
+				}
+				stripe = 0;
+			}
+		}
+	}
+
+#if defined(MTL_SIMD_X86)
+
+	// Accumulates the given number of stripes like hash_accumulate_scalar using SSE2 to process 2
+	// lanes with each instruction.
+	inline void hash_accumulate_sse2(std::uint64_t* accumulators, const char* data, 
+									 const size_t stripe_count, size_t& stripe) noexcept
+	{
+		__m128i acc[4];
+		for (size_t i = 0; i < 4; ++i)
+		{
+			acc[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(accumulators + i * 2));
+		}
+		const __m128i prime = _mm_set1_epi32(static_cast<int>(hash_prime32_1));
+
+		for (size_t s = 0; s < stripe_count; ++s)
+		{
+			const char* stripe_data = data + s * hash_stripe_size;
+			const std::uint64_t* key = hash_secret.data() + stripe;
+			for (size_t i = 0; i < 4; ++i)
+			{
+				const __m128i data_vec = 
+					_mm_loadu_si128(reinterpret_cast<const __m128i*>(stripe_data + i * 16));
+				const __m128i key_vec = 
+					_mm_loadu_si128(reinterpret_cast<const __m128i*>(key + i * 2));
+				const __m128i data_key = _mm_xor_si128(data_vec, key_vec);
+				// multiply the low 32 bits of each lane with the high 32 bits of the same lane
+				const __m128i data_key_high = _mm_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1));
+				const __m128i product = _mm_mul_epu32(data_key, data_key_high);
+				// add each lane of the data to the other lane of the accumulator
+				const __m128i data_swap = _mm_shuffle_epi32(data_vec, _MM_SHUFFLE(1, 0, 3, 2));
+				acc[i] = _mm_add_epi64(acc[i], _mm_add_epi64(product, data_swap));
+			}
+
+			if (++stripe == hash_stripes_per_block)
+			{
+				const std::uint64_t* scramble_key = hash_secret.data() + hash_stripes_per_block;
+				for (size_t i = 0; i < 4; ++i)
+				{
+					const __m128i key_vec = 
+						_mm_loadu_si128(reinterpret_cast<const __m128i*>(scramble_key + i * 2));
+					__m128i value = _mm_xor_si128(acc[i], _mm_srli_epi64(acc[i], 47));
+					value = _mm_xor_si128(value, key_vec);
+					// a 64 bit by 32 bit multiplication made from two 32 bit multiplications
+					const __m128i value_high = _mm_shuffle_epi32(value, _MM_SHUFFLE(0, 3, 0, 1));
+					const __m128i product_low = _mm_mul_epu32(value, prime);
+					const __m128i product_high = _mm_mul_epu32(value_high, prime);
+					acc[i] = _mm_add_epi64(product_low, _mm_slli_epi64(product_high, 32));
+				}
+				stripe = 0;
+			}
+		}
+
+		for (size_t i = 0; i < 4; ++i)
+		{
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(accumulators + i * 2), acc[i]);
+		}
+	}
+
+	// Accumulates the given number of stripes like hash_accumulate_scalar using AVX2 to process 4
+	// lanes with each instruction.
+	MTL_TARGET_AVX2
+	inline void hash_accumulate_avx2(std::uint64_t* accumulators, const char* data, 
+									 const size_t stripe_count, size_t& stripe) noexcept
+	{
+		__m256i acc[2];
+		for (size_t i = 0; i < 2; ++i)
+		{
+			acc[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(accumulators + i * 4));
+		}
+		const __m256i prime = _mm256_set1_epi32(static_cast<int>(hash_prime32_1));
+
+		for (size_t s = 0; s < stripe_count; ++s)
+		{
+			const char* stripe_data = data + s * hash_stripe_size;
+			const std::uint64_t* key = hash_secret.data() + stripe;
+			for (size_t i = 0; i < 2; ++i)
+			{
+				const __m256i data_vec = 
+					_mm256_loadu_si256(reinterpret_cast<const __m256i*>(stripe_data + i * 32));
+				const __m256i key_vec = 
+					_mm256_loadu_si256(reinterpret_cast<const __m256i*>(key + i * 4));
+				const __m256i data_key = _mm256_xor_si256(data_vec, key_vec);
+				const __m256i data_key_high = 
+					_mm256_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1));
+				const __m256i product = _mm256_mul_epu32(data_key, data_key_high);
+				const __m256i data_swap = _mm256_shuffle_epi32(data_vec, _MM_SHUFFLE(1, 0, 3, 2));
+				acc[i] = _mm256_add_epi64(acc[i], _mm256_add_epi64(product, data_swap));
+			}
+
+			if (++stripe == hash_stripes_per_block)
+			{
+				const std::uint64_t* scramble_key = hash_secret.data() + hash_stripes_per_block;
+				for (size_t i = 0; i < 2; ++i)
+				{
+					const __m256i key_vec = 
+						_mm256_loadu_si256(reinterpret_cast<const __m256i*>(scramble_key + i * 4));
+					__m256i value = _mm256_xor_si256(acc[i], _mm256_srli_epi64(acc[i], 47));
+					value = _mm256_xor_si256(value, key_vec);
+					const __m256i value_high = 
+						_mm256_shuffle_epi32(value, _MM_SHUFFLE(0, 3, 0, 1));
+					const __m256i product_low = _mm256_mul_epu32(value, prime);
+					const __m256i product_high = _mm256_mul_epu32(value_high, prime);
+					acc[i] = _mm256_add_epi64(product_low, _mm256_slli_epi64(product_high, 32));
+				}
+				stripe = 0;
+			}
+		}
+
+		for (size_t i = 0; i < 2; ++i)
+		{
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(accumulators + i * 4), acc[i]);
+		}
+	}
+
+#endif // MTL_SIMD_X86 end
+
+	// Accumulates the given number of stripes using the fastest instructions the CPU supports.
+	inline void hash_accumulate(std::uint64_t* accumulators, const char* data, 
+								const size_t stripe_count, size_t& stripe) noexcept
+	{
+#if defined(MTL_SIMD_X86)
+		if (mtl::string::detail::cpu_has_avx2())
+		{
+			hash_accumulate_avx2(accumulators, data, stripe_count, stripe);
+			return;
+		}
+		hash_accumulate_sse2(accumulators, data, stripe_count, stripe);
+#else
+		hash_accumulate_scalar(accumulators, data, stripe_count, stripe);
+#endif // MTL_SIMD_X86 end
+	}
+
+	// Computes the hash of data that arrives in pieces. Hashing the data in one piece or in many
+	// pieces of any size gives the same result.
+	class hash_state
+	{
+		// The 8 lanes of the hash.
+		std::array<std::uint64_t, 8> _accumulators
+		{
+			hash_prime32_3, hash_prime64_1, hash_prime64_2, hash_prime64_3,
+			hash_prime64_4, hash_prime32_2, hash_prime64_5, hash_prime32_1
+		};
+		// The data that doesn't fill a whole stripe yet.
+		std::array<char, hash_stripe_size> _buffer {};
+		// How many bytes the buffer holds.
+		size_t _buffered = 0;
+		// The index of the next stripe inside the current block.
+		size_t _stripe = 0;
+		// The total number of bytes hashed.
+		std::uint64_t _length = 0;
+
+		// Merges the accumulators to a single 64 bit value.
+		[[nodiscard]]
+		static std::uint64_t merge(const std::array<std::uint64_t, 8>& accumulators, 
+								   const size_t secret_offset, const std::uint64_t start) noexcept
+		{
+			std::uint64_t result = start;
+			for (size_t i = 0; i < 8; i += 2)
+			{
+				result += multiply_fold64(accumulators[i] ^ hash_secret[secret_offset + i],
+										  accumulators[i + 1] ^ hash_secret[secret_offset + i + 1]);
+			}
+			return hash_avalanche(result);
+		}
+
+		// Returns the accumulators after the remaining data in the buffer is accumulated as a
+		// stripe padded with zeros. The length is mixed in when merging so the padding doesn't
+		// cause collisions.
+		[[nodiscard]]
+		std::array<std::uint64_t, 8> final_accumulators() const noexcept
+		{
+			auto accumulators = _accumulators;
+			if (_buffered > 0)
+			{
+				std::array<char, hash_stripe_size> last_stripe {};
+				std::memcpy(last_stripe.data(), _buffer.data(), _buffered);
+				size_t stripe = _stripe;
+				hash_accumulate(accumulators.data(), last_stripe.data(), 1, stripe);
+			}
+			return accumulators;
+		}
+
+	public:
+
+		// Adds data to the hash.
+		void update(const char* data, size_t size) noexcept
+		{
+			// empty data like an empty file can come with a null pointer that can't be copied
+			if (size == 0) { return; }
+			_length += size;
+
+			// fill the partial stripe first
+			if (_buffered > 0)
+			{
+				const size_t count = std::min(size, hash_stripe_size - _buffered);
+				std::memcpy(_buffer.data() + _buffered, data, count);
+				_buffered += count;
+				data += count;
+				size -= count;
+				if (_buffered < hash_stripe_size) { return; }
+				hash_accumulate(_accumulators.data(), _buffer.data(), 1, _stripe);
+				_buffered = 0;
+			}
+
+			// accumulate all the whole stripes directly from the data
+			const size_t stripe_count = size / hash_stripe_size;
+			hash_accumulate(_accumulators.data(), data, stripe_count, _stripe);
+			data += stripe_count * hash_stripe_size;
+			size -= stripe_count * hash_stripe_size;
+
+			std::memcpy(_buffer.data(), data, size);
+			_buffered = size;
+		}
+
+		// Returns the 64 bit hash of all the data added.
+		[[nodiscard]]
+		std::uint64_t digest64() const noexcept
+		{
+			return merge(final_accumulators(), 1, _length * hash_prime64_1);
+		}
+
+		// Returns the 128 bit hash of all the data added.
+		[[nodiscard]]
+		hash128 digest128() const noexcept
+		{
+			const auto accumulators = final_accumulators();
+			hash128 result;
+			result.low = merge(accumulators, 1, _length * hash_prime64_1);
+			result.high = merge(accumulators, 11, ~(_length * hash_prime64_2));
+			return result;
+		}
+	};
+
+	// Adds the contents of a file to the hash. The file is memory mapped and when it can't be
+	// mapped it is read in chunks. Returns if the file was read successfully.
+	inline bool hash_file_contents(const std::filesystem::path& filename, hash_state& state)
+	{
+		mtl::filesystem::mapped_file mapped;
+		if (mapped.open(filename))
+		{
+			state.update(mapped.data(), mapped.size());
+			return true;
+		}
+
+		// files that can't be mapped, for example files larger than the address space when
+		// compiling in 32 bit mode, are read in chunks
+		std::ifstream in_file(filename, std::ios::in | std::ios::binary);
+		if (in_file.is_open() == false) { return false; }
+		std::vector<char> buffer(1024 * 1024);
+		while (in_file)
+		{
+			in_file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+			state.update(buffer.data(), static_cast<size_t>(in_file.gcount()));
+		}
+		return in_file.eof();
+	}
+
+} // namespace detail end
+
+
+/// Computes a fast non-cryptographic 64 bit hash of the contents of a file. The file is memory
+/// mapped so it is never copied and the hash is computed with SSE2 or AVX2 when available. The
+/// hash is built like XXH3 but its values are different. Files with identical contents always
+/// have the same hash on every platform. Returns if the file was read successfully.
+/// @param[in] filename The relative or absolute path to a file.
+/// @param[out] hash A 64 bit integer to store the hash.
+/// @return Returns if the file was read successfully.
+inline bool hash_file(const std::filesystem::path& filename, std::uint64_t& hash)
+{
+	mtl::filesystem::detail::hash_state state;
+	if (mtl::filesystem::detail::hash_file_contents(filename, state) == false) { return false; }
+	hash = state.digest64();
+	return true;
+}
+
+/// Computes a fast non-cryptographic 128 bit hash of the contents of a file. The file is memory
+/// mapped so it is never copied and the hash is computed with SSE2 or AVX2 when available. The
+/// hash is built like XXH3 but its values are different. Files with identical contents always
+/// have the same hash on every platform. Returns if the file was read successfully.
+/// @param[in] filename The relative or absolute path to a file.
+/// @param[out] hash An mtl::filesystem::hash128 to store the hash.
+/// @return Returns if the file was read successfully.
+inline bool hash_file(const std::filesystem::path& filename, hash128& hash)
+{
+	mtl::filesystem::detail::hash_state state;
+	if (mtl::filesystem::detail::hash_file_contents(filename, state) == false) { return false; }
+	hash = state.digest128();
+	return true;
 }
 
 
+// ================================================================================================
+// HASH_FILES       - Computes the hash of the contents of many files using multiple threads.
+// ================================================================================================
+
+/// Computes the 128 bit hash of the contents of many files using multiple threads. Each thread
+/// takes the next file that isn't hashed yet so a few large files don't keep the other threads
+/// waiting. The results are stored in the same order as the files and the vector is resized to
+/// the number of files. The hashes are identical to the ones from mtl::filesystem::hash_file.
+/// The container elements have to be convertible to std::filesystem::path. A thread_count of 0
+/// uses as many threads as the hardware supports. Returns if all the files were read
+/// successfully, use mtl::filesystem::file_hash::success to find which ones failed.
+/// @param[in] filenames A container with the paths of the files.
+/// @param[out] hashes A vector of mtl::filesystem::file_hash to store the results.
+/// @param[in] thread_count An optional number of threads to use.
+/// @return Returns if all the files were read successfully.
+template<typename Container>
+inline bool hash_files(const Container& filenames, std::vector<file_hash>& hashes,
+					   size_t thread_count = 0)
+{
+	// keep pointers to the paths so containers without random access can be used
+	std::vector<const typename Container::value_type*> files;
+	files.reserve(static_cast<size_t>(std::distance(std::begin(filenames), std::end(filenames))));
+	for (const auto& filename : filenames) { files.push_back(&filename); }
+
+	hashes.assign(files.size(), file_hash());
+
+	if (thread_count == 0) { thread_count = std::thread::hardware_concurrency(); }
+	if (thread_count > files.size()) { thread_count = files.size(); }
+	if (thread_count == 0) { thread_count = 1; }
+
+	std::atomic<size_t> next_file { 0 };
+	std::vector<std::exception_ptr> errors(thread_count);
+
+	auto worker = [&](const size_t index)
+	{
+		try
+		{
+			size_t current = next_file.fetch_add(1, std::memory_order_relaxed);
+			while (current < files.size())
+			{
+				auto& result = hashes[current];
+				result.success = mtl::filesystem::hash_file(*files[current], result.hash);
+				current = next_file.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+		catch (...)
+		{
+			errors[index] = std::current_exception();
+		}
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve(thread_count - 1);
+	for (size_t i = 1; i < thread_count; ++i)
+	{
+		// if no more threads can be started the files are hashed by the ones running
+		try
+		{
+			threads.emplace_back(worker, i);
+		}
+		// GCOVR_EXCL_START
+		catch (const std::system_error&)
+		{
+			break;
+		}
+		// GCOVR_EXCL_STOP
+	}
+	// the calling thread also hashes files
+	worker(0);
+	for (auto& thread : threads) { thread.join(); }
+
+	// if any of the threads failed rethrow the exception
+	for (const auto& error : errors)
+	{
+		if (error) { std::rethrow_exception(error); }
+	}
+
+	return std::all_of(hashes.begin(), hashes.end(), 
+					   [](const file_hash& result) { return result.success; });
+}
 
 
 
@@ -71,6 +71,7 @@
 // needed headers from fmt
 #include "fmt/format.h"
 #include "fmt/ostream.h"
+#include "fmt/compile.h"
 
 #endif // MTL_EXTERNALLY_SUPPLIED_FMT
 
@@ -12,24 +12,53 @@
 
 
 #include "definitions.hpp"   // various definitions
-#include <algorithm>         // std::copy, std::fill
+#include <algorithm>         // std::copy, std::fill, std::lower_bound
 #include <string>            // std::string, std::string::npos
 #include <string_view>       // std::string_view
-#include <cstring>           // std::strlen, std::strstr, std::strchr
-#include <iterator>          // std::iterator_traits, std::next, std::advance, std::distance
+#include <cstring>           // std::strlen, std::strstr, std::strchr, std::memchr, std::memcmp,
+							 // std::memcpy
+#include <iterator>          // std::iterator_traits, std::next, std::advance, std::distance,
+							 // std::forward_iterator_tag, std::random_access_iterator_tag
 #include <utility>           // std::pair, std::forward
 #include <cmath>             // std::floor, std::ceil
 #include <vector>            // std::vector
 #include <array>             // std::array
-#include <stdexcept>         // std::invalid_argument, std::logic_error
+#include <stdexcept>         // std::invalid_argument, std::logic_error, std::length_error,
+							 // std::out_of_range
 #include <cstddef>           // std::ptrdiff_t
-#include <type_traits>       // std::enable_if_t, std::is_same_v, std::remove_cv_t
+#include <cstdint>           // uint32_t, uint16_t
+#include <initializer_list>  // std::initializer_list
+#include <thread>            // std::thread
+#include <system_error>      // std::system_error
+#include <limits>            // std::numeric_limits
+#include <exception>         // std::exception_ptr, std::current_exception, std::rethrow_exception
+#include <type_traits>       // std::enable_if_t, std::is_same_v, std::remove_cv_t,
+							 // std::is_base_of_v, std::conditional_t, std::make_unsigned_t,
+							 // std::is_signed_v
 #include "type_traits.hpp"   // mtl::is_std_string_v
 #include "container.hpp"     // mtl::emplace_back
-#include "fmt_include.hpp"   // fmt::format, fmt::format_int, fmt::to_string
+#include "fmt_include.hpp"   // fmt::format, fmt::format_int, fmt::to_string, fmt::format_to,
+							 // FMT_COMPILE
 #include "utility.hpp"       // MTL_ASSERT_MSG
 
 
+// x86 SIMD only headers
+#if defined(MTL_SIMD_X86)
+
+#include <immintrin.h> // __m128i, __m256i, _mm_loadu_si128, _mm_cmpeq_epi8, _mm_movemask_epi8,
+					   // _mm256_loadu_si256, _mm256_cmpeq_epi8, _mm256_movemask_epi8,
+					   // _mm_or_si128, _mm256_or_si256, _mm_sub_epi8, _mm_min_epu8,
+					   // _mm_cmpgt_epi8, _mm256_sub_epi8, _mm256_min_epu8, _mm256_cmpgt_epi8,
+					   // _mm_xor_si128, _mm_and_si128, _mm_storeu_si128, _mm256_xor_si256,
+					   // _mm256_and_si256, _mm256_storeu_si256
+
+#if defined(_MSC_VER)
+#include <intrin.h>    // __cpuidex, _xgetbv, _BitScanForward
+#endif // _MSC_VER end
+
+#endif // MTL_SIMD_X86 end
+
+
 namespace mtl
 {
 
@@ -37,11 +66,522 @@ namespace mtl
 namespace string
 {
 
+
+namespace detail
+{
+
+// ------------------------------------------------------------------------------------------------
+// Some helper functions used by the SIMD algorithms.
+// ------------------------------------------------------------------------------------------------
+
+#if defined(MTL_SIMD_X86) && defined(_MSC_VER)
+
+// Reads the XCR0 register that reports which registers the operating system saves.
+#if defined(__clang__)
+__attribute__((target("xsave")))
+#endif // __clang__ end
+inline unsigned long long read_xcr0() noexcept
+{
+	return _xgetbv(0);
+}
+
+#endif // MTL_SIMD_X86 and _MSC_VER end
+
+
+// Returns if both the CPU and the operating system support AVX2. The check happens only once.
+[[nodiscard]]
+inline bool cpu_has_avx2() noexcept
+{
+#if defined(MTL_SIMD_X86)
+
+#if defined(_MSC_VER)
+	static const bool has_avx2 = []() noexcept
+	{
+		int info[4] = {};
+		__cpuidex(info, 0, 0);
+		if (info[0] < 7) { return false; }
+
+		// check the CPU supports AVX and the operating system uses XSAVE
+		__cpuidex(info, 1, 0);
+		const bool osxsave = ((info[2] & (1 << 27)) != 0);
+		const bool avx = ((info[2] & (1 << 28)) != 0);
+		if ((osxsave == false) || (avx == false)) { return false; }
+
+		// check the operating system saves the XMM and YMM registers
+		if ((read_xcr0() & 6) != 6) { return false; }
+
+		__cpuidex(info, 7, 0);
+		return ((info[1] & (1 << 5)) != 0);
+	}();
+#else
+	static const bool has_avx2 = (__builtin_cpu_supports("avx2") != 0);
+#endif // _MSC_VER end
+
+	return has_avx2;
+
+#else
+	return false;
+#endif // MTL_SIMD_X86 end
+}
+
+
+// Returns the index of the lowest set bit. The value can't be 0.
+[[nodiscard]]
+inline unsigned int count_trailing_zeros(const uint32_t value) noexcept
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	unsigned long index = 0;
+	_BitScanForward(&index, value);
+	return static_cast<unsigned int>(index);
+#else
+	return static_cast<unsigned int>(__builtin_ctz(value));
+#endif // _MSC_VER end
+}
+
+
+#if defined(MTL_SIMD_X86)
+
+// Calls the function with the position of every character that matches, using AVX2 to compare 32
+// characters at a time. Stops when less than 32 characters are left and updates the position.
+template<typename Function>
+MTL_TARGET_AVX2
+inline void find_all_chars_avx2(const char* data, const size_t size, const char match,
+								size_t& pos, Function& function)
+{
+	const __m256i needle = _mm256_set1_epi8(match);
+	for (; pos + 32 <= size; pos += 32)
+	{
+		const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+		auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)));
+		while (mask != 0)
+		{
+			function(pos + count_trailing_zeros(mask));
+			// clear the lowest set bit
+			mask = mask & (mask - 1);
+		}
+	}
+}
+
+// Calls the function with the position of every character that matches, using SSE2 to compare 16
+// characters at a time. Stops when less than 16 characters are left and updates the position.
+template<typename Function>
+inline void find_all_chars_sse2(const char* data, const size_t size, const char match,
+								size_t& pos, Function& function)
+{
+	const __m128i needle = _mm_set1_epi8(match);
+	for (; pos + 16 <= size; pos += 16)
+	{
+		const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+		auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)));
+		while (mask != 0)
+		{
+			function(pos + count_trailing_zeros(mask));
+			// clear the lowest set bit
+			mask = mask & (mask - 1);
+		}
+	}
+}
+
+#endif // MTL_SIMD_X86 end
+
+
+// Calls the function with the position of every character in the input that matches, in 
+// increasing order, in a single pass. Uses AVX2 or SSE2 when available and selects between them
+// during runtime, otherwise it uses std::memchr.
+template<typename Function>
+inline void find_all_chars(std::string_view value, const char match, Function&& function)
+{
+	const char* data = value.data();
+	const size_t size = value.size();
+	size_t pos = 0;
+
+#if defined(MTL_SIMD_X86)
+	if (cpu_has_avx2())
+	{
+		find_all_chars_avx2(data, size, match, pos, function);
+	}
+	find_all_chars_sse2(data, size, match, pos, function);
+#endif // MTL_SIMD_X86 end
+
+	// whatever is left is handled without SIMD
+	while (pos < size)
+	{
+		const auto found = static_cast<const char*>(std::memchr(data + pos, match, size - pos));
+		if (found == nullptr) { break; }
+		const auto found_pos = static_cast<size_t>(found - data);
+		function(found_pos);
+		pos = found_pos + 1;
+	}
+}
+
+#if defined(MTL_SIMD_X86)
+
+// Searches for the first character that is equal to either of the two characters, using AVX2 to
+// compare 32 characters at a time. Returns if it was found and updates the position. Stops when
+// less than 32 characters are left.
+MTL_TARGET_AVX2
+inline bool find_first_of_two_avx2(const char* data, const size_t size, const char first,
+								   const char second, size_t& pos) noexcept
+{
+	const __m256i first_needle = _mm256_set1_epi8(first);
+	const __m256i second_needle = _mm256_set1_epi8(second);
+	for (; pos + 32 <= size; pos += 32)
+	{
+		const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+		const __m256i matches = _mm256_or_si256(_mm256_cmpeq_epi8(block, first_needle),
+												_mm256_cmpeq_epi8(block, second_needle));
+		const auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(matches));
+		if (mask != 0)
+		{
+			pos += count_trailing_zeros(mask);
+			return true;
+		}
+	}
+	return false;
+}
+
+// Searches for the first character that is equal to either of the two characters, using SSE2 to
+// compare 16 characters at a time. Returns if it was found and updates the position. Stops when
+// less than 16 characters are left.
+inline bool find_first_of_two_sse2(const char* data, const size_t size, const char first,
+								   const char second, size_t& pos) noexcept
+{
+	const __m128i first_needle = _mm_set1_epi8(first);
+	const __m128i second_needle = _mm_set1_epi8(second);
+	for (; pos + 16 <= size; pos += 16)
+	{
+		const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+		const __m128i matches = _mm_or_si128(_mm_cmpeq_epi8(block, first_needle),
+											 _mm_cmpeq_epi8(block, second_needle));
+		const auto mask = static_cast<uint32_t>(_mm_movemask_epi8(matches));
+		if (mask != 0)
+		{
+			pos += count_trailing_zeros(mask);
+			return true;
+		}
+	}
+	return false;
+}
+
+#endif // MTL_SIMD_X86 end
+
+
+// Returns the position of the first character in the input that is equal to either of the two
+// characters or std::string_view::npos if there is no such character. Uses AVX2 or SSE2 when
+// available and selects between them during runtime.
+[[nodiscard]]
+inline size_t find_first_of_two(std::string_view value, const char first, 
+								const char second) noexcept
+{
+	const char* data = value.data();
+	const size_t size = value.size();
+	size_t pos = 0;
+
+#if defined(MTL_SIMD_X86)
+	if (cpu_has_avx2())
+	{
+		if (find_first_of_two_avx2(data, size, first, second, pos)) { return pos; }
+	}
+	if (find_first_of_two_sse2(data, size, first, second, pos)) { return pos; }
+#endif // MTL_SIMD_X86 end
+
+	// whatever is left is handled without SIMD
+	for (; pos < size; ++pos)
+	{
+		if ((data[pos] == first) || (data[pos] == second)) { return pos; }
+	}
+	return std::string_view::npos;
+}
+
+// The classes of ASCII characters that can be checked for a whole string using SIMD.
+enum class char_class
+{
+	upper,
+	lower,
+	ascii,
+	alphabetic,
+	numeric,
+	alphanumeric
+};
+
+#if defined(MTL_SIMD_X86)
+
+// Returns a mask with all bits set for the characters that are between low and high, inclusive.
+inline __m128i in_range_sse2(const __m128i block, const char low, const char high) noexcept
+{
+	// subtracting the low value moves the range to start at 0 so a single unsigned comparison is
+	// enough, SSE2 has no unsigned comparison but min(x, y) == x is the same as x <= y
+	const __m128i offset = _mm_sub_epi8(block, _mm_set1_epi8(low));
+	const __m128i limit = _mm_set1_epi8(static_cast<char>(high - low));
+	return _mm_cmpeq_epi8(_mm_min_epu8(offset, limit), offset);
+}
+
+// Returns a mask with all bits set for the characters that belong to the class.
+template<char_class Class>
+inline __m128i class_mask_sse2(const __m128i block) noexcept
+{
+	if constexpr (Class == char_class::upper) { return in_range_sse2(block, 'A', 'Z'); }
+	else if constexpr (Class == char_class::lower) { return in_range_sse2(block, 'a', 'z'); }
+	else if constexpr (Class == char_class::ascii)
+	{
+		// ASCII characters are the ones that are not negative as signed values
+		return _mm_cmpgt_epi8(block, _mm_set1_epi8(-1));
+	}
+	else if constexpr (Class == char_class::alphabetic)
+	{
+		// setting the bit 0x20 converts uppercase characters to lowercase and no other character
+		// becomes a lowercase character
+		return in_range_sse2(_mm_or_si128(block, _mm_set1_epi8(0x20)), 'a', 'z');
+	}
+	else if constexpr (Class == char_class::numeric) { return in_range_sse2(block, '0', '9'); }
+	else
+	{
+		return _mm_or_si128(class_mask_sse2<char_class::alphabetic>(block), 
+							class_mask_sse2<char_class::numeric>(block));
+	}
+}
+
+// Returns a mask with all bits set for the characters that are between low and high, inclusive.
+MTL_TARGET_AVX2
+inline __m256i in_range_avx2(const __m256i block, const char low, const char high) noexcept
+{
+	const __m256i offset = _mm256_sub_epi8(block, _mm256_set1_epi8(low));
+	const __m256i limit = _mm256_set1_epi8(static_cast<char>(high - low));
+	return _mm256_cmpeq_epi8(_mm256_min_epu8(offset, limit), offset);
+}
+
+// Returns a mask with all bits set for the characters that belong to the class.
+template<char_class Class>
+MTL_TARGET_AVX2
+inline __m256i class_mask_avx2(const __m256i block) noexcept
+{
+	if constexpr (Class == char_class::upper) { return in_range_avx2(block, 'A', 'Z'); }
+	else if constexpr (Class == char_class::lower) { return in_range_avx2(block, 'a', 'z'); }
+	else if constexpr (Class == char_class::ascii)
+	{
+		return _mm256_cmpgt_epi8(block, _mm256_set1_epi8(-1));
+	}
+	else if constexpr (Class == char_class::alphabetic)
+	{
+		return in_range_avx2(_mm256_or_si256(block, _mm256_set1_epi8(0x20)), 'a', 'z');
+	}
+	else if constexpr (Class == char_class::numeric) { return in_range_avx2(block, '0', '9'); }
+	else
+	{
+		return _mm256_or_si256(class_mask_avx2<char_class::alphabetic>(block), 
+							   class_mask_avx2<char_class::numeric>(block));
+	}
+}
+
+// Checks 32 characters at a time using AVX2 if they all belong to the class. Returns false as
+// soon as a character doesn't belong to the class. Stops when less than 32 characters are left
+// and updates the position.
+template<char_class Class>
+MTL_TARGET_AVX2
+inline bool all_of_class_avx2(const char* data, const size_t size, size_t& pos) noexcept
+{
+	for (; pos + 32 <= size; pos += 32)
+	{
+		const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+		const auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+												class_mask_avx2<Class>(block)));
+		if (mask != 0xFFFFFFFF) { return false; }
+	}
+	return true;
+}
+
+// Checks 16 characters at a time using SSE2 if they all belong to the class. Returns false as
+// soon as a character doesn't belong to the class. Stops when less than 16 characters are left
+// and updates the position.
+template<char_class Class>
+inline bool all_of_class_sse2(const char* data, const size_t size, size_t& pos) noexcept
+{
+	for (; pos + 16 <= size; pos += 16)
+	{
+		const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+		const auto mask = static_cast<uint32_t>(_mm_movemask_epi8(class_mask_sse2<Class>(block)));
+		if (mask != 0xFFFF) { return false; }
+	}
+	return true;
+}
+
+#endif // MTL_SIMD_X86 end
+
+
+// Checks as many characters as possible using AVX2 or SSE2, selecting between them during
+// runtime, if they all belong to the class. Returns false if a character that doesn't belong to
+// the class was found. The position is where the characters that are left have to be checked
+// without SIMD.
+template<char_class Class>
+[[nodiscard]]
+inline bool all_of_class([[maybe_unused]] const std::string_view value, size_t& pos) noexcept
+{
+	pos = 0;
+#if defined(MTL_SIMD_X86)
+	// strings shorter than 16 characters are faster to check without SIMD
+	if (value.size() < 16) { return true; }
+	if (cpu_has_avx2())
+	{
+		if (all_of_class_avx2<Class>(value.data(), value.size(), pos) == false) { return false; }
+	}
+	if (all_of_class_sse2<Class>(value.data(), value.size(), pos) == false) { return false; }
+#endif // MTL_SIMD_X86 end
+	return true;
+}
+
+#if defined(MTL_SIMD_X86)
+
+// Converts the case of 32 characters at a time using AVX2 and writes them to the output, which
+// can be the same as the input. When converting to uppercase only lowercase ASCII letters are
+// changed and when converting to lowercase only uppercase ASCII letters are changed. Stops when
+// less than 32 characters are left and updates the position.
+template<bool ToUpper>
+MTL_TARGET_AVX2
+inline void convert_case_avx2(const char* input, char* output, const size_t size, 
+							  size_t& pos) noexcept
+{
+	const __m256i case_bit = _mm256_set1_epi8(0x20);
+	for (; pos + 32 <= size; pos += 32)
+	{
+		const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + pos));
+		const __m256i letters = ToUpper ? in_range_avx2(block, 'a', 'z') : 
+										  in_range_avx2(block, 'A', 'Z');
+		// flipping the bit 0x20 of a letter changes its case
+		const __m256i result = _mm256_xor_si256(block, _mm256_and_si256(letters, case_bit));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(output + pos), result);
+	}
+}
+
+// Converts the case of 16 characters at a time using SSE2 and writes them to the output, which
+// can be the same as the input. When converting to uppercase only lowercase ASCII letters are
+// changed and when converting to lowercase only uppercase ASCII letters are changed. Stops when
+// less than 16 characters are left and updates the position.
+template<bool ToUpper>
+inline void convert_case_sse2(const char* input, char* output, const size_t size, 
+							  size_t& pos) noexcept
+{
+	const __m128i case_bit = _mm_set1_epi8(0x20);
+	for (; pos + 16 <= size; pos += 16)
+	{
+		const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + pos));
+		const __m128i letters = ToUpper ? in_range_sse2(block, 'a', 'z') : 
+										  in_range_sse2(block, 'A', 'Z');
+		// flipping the bit 0x20 of a letter changes its case
+		const __m128i result = _mm_xor_si128(block, _mm_and_si128(letters, case_bit));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(output + pos), result);
+	}
+}
+
+#endif // MTL_SIMD_X86 end
+
+
+// Converts the case of the ASCII letters of the input and writes all the characters to the
+// output, which can be the same as the input. Uses AVX2 or SSE2 when available and selects
+// between them during runtime.
+template<bool ToUpper>
+inline void convert_case(const char* input, char* output, const size_t size) noexcept
+{
+	size_t pos = 0;
+#if defined(MTL_SIMD_X86)
+	// strings shorter than 16 characters are faster to convert without SIMD
+	if (size >= 16)
+	{
+		if (cpu_has_avx2())
+		{
+			convert_case_avx2<ToUpper>(input, output, size, pos);
+		}
+		convert_case_sse2<ToUpper>(input, output, size, pos);
+	}
+#endif // MTL_SIMD_X86 end
+
+	// whatever is left is handled without SIMD
+	for (; pos < size; ++pos)
+	{
+		const char character = input[pos];
+		const char first = ToUpper ? 'a' : 'A';
+		const bool letter = (static_cast<unsigned char>(character - first) <= 25);
+		output[pos] = letter ? static_cast<char>(character ^ 0x20) : character;
+	}
+}
+
+#if defined(MTL_SIMD_X86)
+
+// Searches for a pattern of at least 2 characters using AVX2. Compares the first and the last
+// character of the pattern with 32 positions at a time and only compares the rest of the pattern
+// at the positions where both of them match. Returns the position of the first match or
+// std::string_view::npos. Stops when there is not enough input left for a whole step and updates
+// the position.
+MTL_TARGET_AVX2
+inline size_t find_first_last_avx2(const char* data, const size_t size, const char* pattern,
+								   const size_t length, size_t& pos) noexcept
+{
+	const __m256i first = _mm256_set1_epi8(pattern[0]);
+	const __m256i last = _mm256_set1_epi8(pattern[length - 1]);
+	for (; pos + length - 1 + 32 <= size; pos += 32)
+	{
+		const __m256i block_first = 
+			_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+		const __m256i block_last = 
+			_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos + length - 1));
+		const __m256i matches = _mm256_and_si256(_mm256_cmpeq_epi8(block_first, first),
+												 _mm256_cmpeq_epi8(block_last, last));
+		auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(matches));
+		while (mask != 0)
+		{
+			const size_t candidate = pos + count_trailing_zeros(mask);
+			if (std::memcmp(data + candidate + 1, pattern + 1, length - 2) == 0)
+			{
+				return candidate;
+			}
+			// clear the lowest set bit
+			mask = mask & (mask - 1);
+		}
+	}
+	return std::string_view::npos;
+}
+
+// Searches for a pattern of at least 2 characters using SSE2. Compares the first and the last
+// character of the pattern with 16 positions at a time and only compares the rest of the pattern
+// at the positions where both of them match. Returns the position of the first match or
+// std::string_view::npos. Stops when there is not enough input left for a whole step and updates
+// the position.
+inline size_t find_first_last_sse2(const char* data, const size_t size, const char* pattern,
+								   const size_t length, size_t& pos) noexcept
+{
+	const __m128i first = _mm_set1_epi8(pattern[0]);
+	const __m128i last = _mm_set1_epi8(pattern[length - 1]);
+	for (; pos + length - 1 + 16 <= size; pos += 16)
+	{
+		const __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+		const __m128i block_last = 
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + length - 1));
+		const __m128i matches = _mm_and_si128(_mm_cmpeq_epi8(block_first, first),
+											  _mm_cmpeq_epi8(block_last, last));
+		auto mask = static_cast<uint32_t>(_mm_movemask_epi8(matches));
+		while (mask != 0)
+		{
+			const size_t candidate = pos + count_trailing_zeros(mask);
+			if (std::memcmp(data + candidate + 1, pattern + 1, length - 2) == 0)
+			{
+				return candidate;
+			}
+			// clear the lowest set bit
+			mask = mask & (mask - 1);
+		}
+	}
+	return std::string_view::npos;
+}
+
+#endif // MTL_SIMD_X86 end
+
+} // namespace detail end
+
+
 // ================================================================================================
 // IS_UPPER - Returns if a character is an uppercase ASCII character.
-// IS_UPPER - Returns if all characters in an std::string are uppercase ASCII characters.
+// IS_UPPER - Returns if all characters in a string are uppercase ASCII characters.
 // IS_LOWER - Returns if a character is a lowercase ASCII character.
-// IS_LOWER - Returns if all characters in an std::string are lowercase ASCII characters.
+// IS_LOWER - Returns if all characters in a string are lowercase ASCII characters.
 // ================================================================================================
 
 /// Returns if a character is an uppercase ASCII character.
@@ -58,15 +598,23 @@ inline bool is_upper(const char character) noexcept
 	return false;
 }
 
-/// Returns if all characters in an std::string are uppercase ASCII characters.
-/// @param[in] value An std::string to check.
+/// Returns if all characters in an std::string_view are uppercase ASCII characters. Checks 16 or
+/// 32 characters at a time using SSE2 or AVX2 when available.
+/// @param[in] value An std::string_view to check.
 /// @return If all the characters are uppercase ASCII characters.
 [[nodiscard]]
-inline bool is_upper(const std::string& value) noexcept
+inline bool is_upper(const std::string_view value) noexcept
 {
-	for (const char character : value)
+	using mtl::string::detail::char_class;
+	size_t pos = 0;
+	if (mtl::string::detail::all_of_class<char_class::upper>(value, pos) == false)
 	{
-		if (is_upper(character) == false)
+		return false;
+	}
+	// check the characters that are left one at a time
+	for (; pos < value.size(); ++pos)
+	{
+		if (is_upper(value[pos]) == false)
 		{
 			return false;
 		}
@@ -74,6 +622,24 @@ inline bool is_upper(const std::string& value) noexcept
 	return true;
 }
 
+/// Returns if all characters in an std::string are uppercase ASCII characters.
+/// @param[in] value An std::string to check.
+/// @return If all the characters are uppercase ASCII characters.
+[[nodiscard]]
+inline bool is_upper(const std::string& value) noexcept
+{
+	return is_upper(std::string_view(value));
+}
+
+/// Returns if all characters in a null-terminated string are uppercase ASCII characters.
+/// @param[in] value A null-terminated string to check.
+/// @return If all the characters are uppercase ASCII characters.
+[[nodiscard]]
+inline bool is_upper(const char* value) noexcept
+{
+	return is_upper(std::string_view(value));
+}
+
 
 /// Returns if a character is a lowercase ASCII character.
 /// @param[in] character A character to check.
@@ -89,15 +655,23 @@ inline bool is_lower(const char character) noexcept
 	return false;
 }
 
-/// Returns if all characters in an std::string are lowercase ASCII characters.
-/// @param[in] value An std::string to check.
+/// Returns if all characters in an std::string_view are lowercase ASCII characters. Checks 16 or
+/// 32 characters at a time using SSE2 or AVX2 when available.
+/// @param[in] value An std::string_view to check.
 /// @return If all the characters are lowercase ASCII characters.
 [[nodiscard]]
-inline bool is_lower(const std::string& value) noexcept
+inline bool is_lower(const std::string_view value) noexcept
 {
-	for (const char character : value)
+	using mtl::string::detail::char_class;
+	size_t pos = 0;
+	if (mtl::string::detail::all_of_class<char_class::lower>(value, pos) == false)
+	{
+		return false;
+	}
+	// check the characters that are left one at a time
+	for (; pos < value.size(); ++pos)
 	{
-		if (is_lower(character) == false)
+		if (is_lower(value[pos]) == false)
 		{
 			return false;
 		}
@@ -105,12 +679,32 @@ inline bool is_lower(const std::string& value) noexcept
 	return true;
 }
 
+/// Returns if all characters in an std::string are lowercase ASCII characters.
+/// @param[in] value An std::string to check.
+/// @return If all the characters are lowercase ASCII characters.
+[[nodiscard]]
+inline bool is_lower(const std::string& value) noexcept
+{
+	return is_lower(std::string_view(value));
+}
+
+/// Returns if all characters in a null-terminated string are lowercase ASCII characters.
+/// @param[in] value A null-terminated string to check.
+/// @return If all the characters are lowercase ASCII characters.
+[[nodiscard]]
+inline bool is_lower(const char* value) noexcept
+{
+	return is_lower(std::string_view(value));
+}
+
 
 // ================================================================================================
 // TO_UPPER - Converts a lowercase ASCII character to uppercase.
 // TO_UPPER - Converts all lowercase ASCII characters of an std::string to uppercase.
 // TO_LOWER - Converts an uppercase ASCII character to lowercase.
 // TO_LOWER - Converts all uppercase ASCII characters of an std::string to lowercase.
+// TO_UPPER - Converts an std::string_view to uppercase and writes it to a buffer.
+// TO_LOWER - Converts an std::string_view to lowercase and writes it to a buffer.
 // ================================================================================================
 
 /// Converts a lowercase ASCII character to uppercase.
@@ -127,14 +721,37 @@ inline void to_upper(char& character) noexcept
 	}
 }
 
-/// Converts all lowercase ASCII characters in an std::string to uppercase.
+/// Converts all lowercase ASCII characters in an std::string to uppercase. Converts 16 or 32
+/// characters at a time using SSE2 or AVX2 when available.
 /// @param[in, out] value An std::string to convert all it's characters to uppercase.
 inline void to_upper(std::string& value) noexcept
 {
-	for (char& character : value) 
-	{ 
-		to_upper(character); 
-	}
+	mtl::string::detail::convert_case<true>(value.data(), value.data(), value.size());
+}
+
+/// Converts all lowercase ASCII characters of an std::string_view to uppercase and writes all the
+/// characters to the output. The output must have space for at least as many characters as the
+/// std::string_view has. Converts 16 or 32 characters at a time using SSE2 or AVX2 when
+/// available. Returns a pointer right after the last character written.
+/// @param[in] value An std::string_view to convert to uppercase.
+/// @param[out] output A pointer to where the converted characters will be written.
+/// @return A pointer right after the last character written.
+inline char* to_upper(const std::string_view value, char* output) noexcept
+{
+	mtl::string::detail::convert_case<true>(value.data(), output, value.size());
+	return output + value.size();
+}
+
+/// Converts all lowercase ASCII characters of an std::string_view to uppercase and stores the
+/// result to the output std::string, replacing its contents. The memory the output already has
+/// is reused so converting many strings with the same output allocates only when a string is
+/// longer than all the previous ones.
+/// @param[in] value An std::string_view to convert to uppercase.
+/// @param[out] output An std::string where the converted characters will be stored.
+inline void to_upper(const std::string_view value, std::string& output)
+{
+	output.resize(value.size());
+	mtl::string::detail::convert_case<true>(value.data(), output.data(), value.size());
 }
 
 /// Converts an uppercase ASCII character to lowercase.
@@ -151,21 +768,44 @@ inline void to_lower(char& character) noexcept
 	}
 }
 
-/// Converts all uppercase ASCII characters of an std::string to lowercase characters.
+/// Converts all uppercase ASCII characters of an std::string to lowercase characters. Converts
+/// 16 or 32 characters at a time using SSE2 or AVX2 when available.
 /// @param[in, out] value An std::string to convert all it's characters to lowercase.
 inline void to_lower(std::string& value) noexcept
 {
-	for (char& character : value) 
-	{ 
-		to_lower(character); 
-	}
+	mtl::string::detail::convert_case<false>(value.data(), value.data(), value.size());
+}
+
+/// Converts all uppercase ASCII characters of an std::string_view to lowercase and writes all the
+/// characters to the output. The output must have space for at least as many characters as the
+/// std::string_view has. Converts 16 or 32 characters at a time using SSE2 or AVX2 when
+/// available. Returns a pointer right after the last character written.
+/// @param[in] value An std::string_view to convert to lowercase.
+/// @param[out] output A pointer to where the converted characters will be written.
+/// @return A pointer right after the last character written.
+inline char* to_lower(const std::string_view value, char* output) noexcept
+{
+	mtl::string::detail::convert_case<false>(value.data(), output, value.size());
+	return output + value.size();
+}
+
+/// Converts all uppercase ASCII characters of an std::string_view to lowercase and stores the
+/// result to the output std::string, replacing its contents. The memory the output already has
+/// is reused so converting many strings with the same output allocates only when a string is
+/// longer than all the previous ones.
+/// @param[in] value An std::string_view to convert to lowercase.
+/// @param[out] output An std::string where the converted characters will be stored.
+inline void to_lower(const std::string_view value, std::string& output)
+{
+	output.resize(value.size());
+	mtl::string::detail::convert_case<false>(value.data(), output.data(), value.size());
 }
 
 
 
 // ================================================================================================
 // IS_ASCII - Returns if char is an ASCII character.
-// IS_ASCII - Returns if all characters in an std::string are ASCII characters.
+// IS_ASCII - Returns if all characters in a string are ASCII characters.
 // ================================================================================================
 
 /// Returns if the character is an ASCII character.
@@ -183,16 +823,23 @@ inline bool is_ascii(const char character) noexcept
 	return false;
 }
 
-/// Returns if all the characters in an std::string are ASCII characters.
-/// @param[in] value An std::string to check.
-/// @return If all characters of the std::string are ASCII characters.
+/// Returns if all characters in an std::string_view are ASCII characters. Checks 16 or 32
+/// characters at a time using SSE2 or AVX2 when available.
+/// @param[in] value An std::string_view to check.
+/// @return If all the characters are ASCII characters.
 [[nodiscard]]
-inline bool is_ascii(const std::string& value) noexcept
+inline bool is_ascii(const std::string_view value) noexcept
 {
-	for (const char character : value)
+	using mtl::string::detail::char_class;
+	size_t pos = 0;
+	if (mtl::string::detail::all_of_class<char_class::ascii>(value, pos) == false)
 	{
-		// check if there are any non-ASCII characters
-		if (is_ascii(character) == false)
+		return false;
+	}
+	// check the characters that are left one at a time
+	for (; pos < value.size(); ++pos)
+	{
+		if (is_ascii(value[pos]) == false)
 		{
 			return false;
 		}
@@ -200,13 +847,31 @@ inline bool is_ascii(const std::string& value) noexcept
 	return true;
 }
 
+/// Returns if all characters in an std::string are ASCII characters.
+/// @param[in] value An std::string to check.
+/// @return If all the characters are ASCII characters.
+[[nodiscard]]
+inline bool is_ascii(const std::string& value) noexcept
+{
+	return is_ascii(std::string_view(value));
+}
+
+/// Returns if all characters in a null-terminated string are ASCII characters.
+/// @param[in] value A null-terminated string to check.
+/// @return If all the characters are ASCII characters.
+[[nodiscard]]
+inline bool is_ascii(const char* value) noexcept
+{
+	return is_ascii(std::string_view(value));
+}
+
 
 
 // ================================================================================================
-// IS_ALPHABETIC - Returns if a character / all characters in std::string are ASCII alphabetic 
+// IS_ALPHABETIC - Returns if a character / all characters in a string are ASCII alphabetic 
 //                 characters or not.
-// IS_NUMERIC    - Returns if a character / all characters in std::string are ASCII numbers or not.
-// IS_ALPHANUM   - Returns if a character / all characters in std::string are ASCII alphanumeric 
+// IS_NUMERIC    - Returns if a character / all characters in a string are ASCII numbers or not.
+// IS_ALPHANUM   - Returns if a character / all characters in a string are ASCII alphanumeric 
 //                 characters or not.
 // ================================================================================================
 
@@ -224,16 +889,23 @@ inline bool is_alphabetic(const char character) noexcept
 	return false;
 }
 
-/// Returns if all characters in an std::string are ASCII alphabetic characters.
-/// @param[in] value An std::string to check.
-/// @return If all the characters of an std::string are ASCII alphabetic characters.
+/// Returns if all characters in an std::string_view are ASCII alphabetic characters. Checks 16 or
+/// 32 characters at a time using SSE2 or AVX2 when available.
+/// @param[in] value An std::string_view to check.
+/// @return If all the characters are ASCII alphabetic characters.
 [[nodiscard]]
-inline bool is_alphabetic(const std::string& value) noexcept
+inline bool is_alphabetic(const std::string_view value) noexcept
 {
-	for (const char character : value)
+	using mtl::string::detail::char_class;
+	size_t pos = 0;
+	if (mtl::string::detail::all_of_class<char_class::alphabetic>(value, pos) == false)
+	{
+		return false;
+	}
+	// check the characters that are left one at a time
+	for (; pos < value.size(); ++pos)
 	{
-		// if the character isn't alphanumeric
-		if (is_alphabetic(character) == false)
+		if (is_alphabetic(value[pos]) == false)
 		{
 			return false;
 		}
@@ -241,6 +913,24 @@ inline bool is_alphabetic(const std::string& value) noexcept
 	return true;
 }
 
+/// Returns if all characters in an std::string are ASCII alphabetic characters.
+/// @param[in] value An std::string to check.
+/// @return If all the characters are ASCII alphabetic characters.
+[[nodiscard]]
+inline bool is_alphabetic(const std::string& value) noexcept
+{
+	return is_alphabetic(std::string_view(value));
+}
+
+/// Returns if all characters in a null-terminated string are ASCII alphabetic characters.
+/// @param[in] value A null-terminated string to check.
+/// @return If all the characters are ASCII alphabetic characters.
+[[nodiscard]]
+inline bool is_alphabetic(const char* value) noexcept
+{
+	return is_alphabetic(std::string_view(value));
+}
+
 /// Returns if a character is an ASCII number.
 /// @param[in] character A character to check.
 /// @return If the character is an ASCII number.
@@ -255,16 +945,23 @@ inline bool is_numeric(const char character) noexcept
 	return false;
 }
 
-/// Returns if all characters in an std::string are ASCII numbers.
-/// @param[in] value An std::string to check.
-/// @return If all the characters of an std::string are ASCII numeric characters.
+/// Returns if all characters in an std::string_view are ASCII numbers. Checks 16 or 32 characters
+/// at a time using SSE2 or AVX2 when available.
+/// @param[in] value An std::string_view to check.
+/// @return If all the characters are ASCII numeric characters.
 [[nodiscard]]
-inline bool is_numeric(const std::string& value) noexcept
+inline bool is_numeric(const std::string_view value) noexcept
 {
-	for (const char character : value)
+	using mtl::string::detail::char_class;
+	size_t pos = 0;
+	if (mtl::string::detail::all_of_class<char_class::numeric>(value, pos) == false)
+	{
+		return false;
+	}
+	// check the characters that are left one at a time
+	for (; pos < value.size(); ++pos)
 	{
-		// if the character isn't alphanumeric
-		if (is_numeric(character) == false)
+		if (is_numeric(value[pos]) == false)
 		{
 			return false;
 		}
@@ -272,6 +969,24 @@ inline bool is_numeric(const std::string& value) noexcept
 	return true;
 }
 
+/// Returns if all characters in an std::string are ASCII numbers.
+/// @param[in] value An std::string to check.
+/// @return If all the characters are ASCII numeric characters.
+[[nodiscard]]
+inline bool is_numeric(const std::string& value) noexcept
+{
+	return is_numeric(std::string_view(value));
+}
+
+/// Returns if all characters in a null-terminated string are ASCII numbers.
+/// @param[in] value A null-terminated string to check.
+/// @return If all the characters are ASCII numeric characters.
+[[nodiscard]]
+inline bool is_numeric(const char* value) noexcept
+{
+	return is_numeric(std::string_view(value));
+}
+
 /// Returns if a character is an ASCII alphabetic or numeric character.
 /// @param[in] character A character to check.
 /// @return If the character is an ASCII alphanumeric character.
@@ -285,16 +1000,23 @@ inline bool is_alphanum(const char character) noexcept
 	return false;
 }
 
-/// Returns if all characters in an std::string are ASCII alphabetic or numeric characters.
-/// @param[in] value An std::string to check.
-/// @return If all the characters of an std::string are ASCII alphanumeric characters.
+/// Returns if all characters in an std::string_view are ASCII alphabetic or numeric characters.
+/// Checks 16 or 32 characters at a time using SSE2 or AVX2 when available.
+/// @param[in] value An std::string_view to check.
+/// @return If all the characters are ASCII alphanumeric characters.
 [[nodiscard]]
-inline bool is_alphanum(const std::string& value) noexcept
+inline bool is_alphanum(const std::string_view value) noexcept
 {
-	for (const char character : value)
+	using mtl::string::detail::char_class;
+	size_t pos = 0;
+	if (mtl::string::detail::all_of_class<char_class::alphanumeric>(value, pos) == false)
+	{
+		return false;
+	}
+	// check the characters that are left one at a time
+	for (; pos < value.size(); ++pos)
 	{
-		// if the character isn't alphanumeric
-		if (is_alphanum(character) == false)
+		if (is_alphanum(value[pos]) == false)
 		{
 			return false;
 		}
@@ -302,6 +1024,25 @@ inline bool is_alphanum(const std::string& value) noexcept
 	return true;
 }
 
+/// Returns if all characters in an std::string are ASCII alphabetic or numeric characters.
+/// @param[in] value An std::string to check.
+/// @return If all the characters are ASCII alphanumeric characters.
+[[nodiscard]]
+inline bool is_alphanum(const std::string& value) noexcept
+{
+	return is_alphanum(std::string_view(value));
+}
+
+/// Returns if all characters in a null-terminated string are ASCII alphabetic or numeric
+/// characters.
+/// @param[in] value A null-terminated string to check.
+/// @return If all the characters are ASCII alphanumeric characters.
+[[nodiscard]]
+inline bool is_alphanum(const char* value) noexcept
+{
+	return is_alphanum(std::string_view(value));
+}
+
 
 // ================================================================================================
 // CONTAINS - Returns if a substring exists within a string. 
@@ -428,6 +1169,437 @@ inline bool contains(const char* value, const char match)
 
 
 
+// ================================================================================================
+// SEARCHER - Searches for the same substring in many strings.
+// ================================================================================================
+
+/// Searches for the same substring in many strings. The work that only depends on the substring
+/// is done once when the mtl::string::searcher is created so it is not repeated for every string
+/// that is searched. When SSE2 or AVX2 is available it compares the first and the last character
+/// of the substring with 16 or 32 positions at a time and compares the whole substring only where
+/// both of them match. Otherwise it uses the Boyer-Moore-Horspool algorithm that skips positions
+/// using a precomputed table of shifts.
+class searcher
+{
+	// The substring we search for.
+	std::string _pattern;
+	// For every character how far the search can move when it is the last character of the 
+	// current window and there is no match.
+	std::array<size_t, 256> _shift {};
+
+	// Searches from the given position using the Boyer-Moore-Horspool algorithm. The pattern has
+	// at least 2 characters.
+	[[nodiscard]]
+	size_t find_horspool(const std::string_view value, size_t pos) const noexcept
+	{
+		const size_t length = _pattern.size();
+		const char* data = value.data();
+		const char last = _pattern[length - 1];
+		while (pos + length <= value.size())
+		{
+			const char current = data[pos + length - 1];
+			if ((current == last) && (std::memcmp(data + pos, _pattern.data(), length - 1) == 0))
+			{
+				return pos;
+			}
+			pos += _shift[static_cast<unsigned char>(current)];
+		}
+		return std::string_view::npos;
+	}
+
+public:
+
+	/// Default constructor that creates a searcher for an empty substring.
+	searcher() = default;
+
+	/// Constructor that creates a searcher for the given substring.
+	/// @param[in] pattern The substring to search for.
+	explicit searcher(const std::string_view pattern) : _pattern(pattern)
+	{
+		const size_t length = _pattern.size();
+		_shift.fill(length);
+		// the last character is excluded because finding it at the end of the window tells us 
+		// nothing about where the next possible match is
+		for (size_t i = 0; i + 1 < length; ++i)
+		{
+			_shift[static_cast<unsigned char>(_pattern[i])] = length - 1 - i;
+		}
+	}
+
+	/// Returns the substring the searcher searches for.
+	/// @return The substring the searcher searches for.
+	[[nodiscard]]
+	const std::string& pattern() const noexcept { return _pattern; }
+
+	/// Returns the position of the first match at or after the given position or
+	/// std::string_view::npos if there is no match. Like std::string_view::find an empty
+	/// substring matches at the given position.
+	/// @param[in] value An std::string_view to search.
+	/// @param[in] pos An optional position to start searching from.
+	/// @return The position of the first match or std::string_view::npos.
+	[[nodiscard]]
+	size_t find(const std::string_view value, size_t pos = 0) const noexcept
+	{
+		const size_t length = _pattern.size();
+		if (pos > value.size()) { return std::string_view::npos; }
+		if (length == 0) { return pos; }
+		if (length > value.size() - pos) { return std::string_view::npos; }
+
+		if (length == 1)
+		{
+			const auto found = static_cast<const char*>(
+				std::memchr(value.data() + pos, _pattern[0], value.size() - pos));
+			if (found == nullptr) { return std::string_view::npos; }
+			return static_cast<size_t>(found - value.data());
+		}
+
+#if defined(MTL_SIMD_X86)
+		size_t found = std::string_view::npos;
+		if (mtl::string::detail::cpu_has_avx2())
+		{
+			found = mtl::string::detail::find_first_last_avx2(value.data(), value.size(), 
+															  _pattern.data(), length, pos);
+			if (found != std::string_view::npos) { return found; }
+		}
+		found = mtl::string::detail::find_first_last_sse2(value.data(), value.size(), 
+														  _pattern.data(), length, pos);
+		if (found != std::string_view::npos) { return found; }
+#endif // MTL_SIMD_X86 end
+
+		// whatever is left is searched without SIMD
+		return find_horspool(value, pos);
+	}
+
+	/// Returns if the substring is found inside the input string. An empty substring is always
+	/// found.
+	/// @param[in] value An std::string_view to search.
+	/// @return If the substring was found.
+	[[nodiscard]]
+	bool contains(const std::string_view value) const noexcept
+	{
+		return (find(value) != std::string_view::npos);
+	}
+
+	/// Finds the positions of all the matches and adds them to the container. Matches don't 
+	/// overlap, the search continues after the end of each match the same way that 
+	/// mtl::string::split and mtl::string::replace treat matches. An empty substring has no
+	/// matches. Returns the number of matches found.
+	/// @param[in] value An std::string_view to search.
+	/// @param[out] positions A container of integral values to add the positions of the matches.
+	/// @return The number of matches found.
+	template<typename Container>
+	size_t find_all(const std::string_view value, Container& positions) const
+	{
+		if (_pattern.empty()) { return 0; }
+		size_t count = 0;
+		size_t pos = find(value);
+		while (pos != std::string_view::npos)
+		{
+			mtl::emplace_back(positions, pos);
+			++count;
+			pos = find(value, pos + _pattern.size());
+		}
+		return count;
+	}
+};
+
+
+
+// ================================================================================================
+// MULTI_SEARCHER - Searches for many substrings at the same time in a single pass.
+// ================================================================================================
+
+/// A match found by mtl::string::multi_searcher.
+struct multi_match
+{
+	/// The index of the substring that matched, in the order the substrings were given.
+	size_t pattern = 0;
+	/// The position in the input where the match starts.
+	size_t position = 0;
+	/// The length of the match.
+	size_t length = 0;
+};
+
+/// Searches for many substrings at the same time reading the input only once, so the time it
+/// takes depends on the size of the input and not on the number of substrings. The substrings are
+/// compiled to an Aho-Corasick automaton stored as a single flat table of transitions. To keep
+/// the table small characters that don't appear in any substring share a single column. Empty
+/// substrings never match. When the same substring is given more than once only the first one is
+/// reported.
+class multi_searcher
+{
+	// Marks a state where no substring ends.
+	static constexpr uint32_t no_pattern = 0xFFFFFFFF;
+	// The bit of a transition that is set when a substring ends at the next state.
+	static constexpr uint32_t match_bit = 0x80000000;
+
+	// The column of the transition table for each character.
+	std::array<uint16_t, 256> _classes {};
+	// The number of columns of the transition table.
+	size_t _class_count = 1;
+	// The next state for every state and column, stored one state after the other. After the
+	// automaton is built each transition holds the position of the row of the next state instead
+	// of its index, so no multiplication is needed to move to it, and the match_bit is set when
+	// a substring ends at the next state.
+	std::vector<uint32_t> _transitions;
+	// For each state the index of the substring that ends there or no_pattern.
+	std::vector<uint32_t> _pattern_at;
+	// For each state the first state, itself included, where a substring ends while following
+	// the failure links or 0 if there is none.
+	std::vector<uint32_t> _match_state;
+	// For each state the next state after it where a shorter substring ends or 0 if there is
+	// none.
+	std::vector<uint32_t> _output_link;
+	// The length of each substring.
+	std::vector<size_t> _lengths;
+	// For each state the number of characters from the root to it.
+	std::vector<uint32_t> _depths;
+
+	// Returns the transition from the row for a character.
+	[[nodiscard]]
+	uint32_t next_transition(const uint32_t row, const char character) const noexcept
+	{
+		return _transitions[row + _classes[static_cast<unsigned char>(character)]];
+	}
+
+	// Returns the state a transition leads to.
+	[[nodiscard]]
+	uint32_t transition_state(const uint32_t transition) const noexcept
+	{
+		return static_cast<uint32_t>((transition & ~match_bit) / _class_count);
+	}
+
+	// Creates the automaton from the substrings.
+	template<typename Container>
+	void build(const Container& patterns)
+	{
+		// give a column to every character that appears in a substring, column 0 is shared by
+		// all the other characters
+		for (const auto& element : patterns)
+		{
+			const std::string_view pattern(element);
+			for (const char character : pattern)
+			{
+				auto& column = _classes[static_cast<unsigned char>(character)];
+				if (column == 0) { column = static_cast<uint16_t>(_class_count++); }
+			}
+		}
+
+		// build the trie, state 0 is the root and a transition to 0 means there is no child 
+		// because no transition of the trie leads back to the root
+		_transitions.assign(_class_count, 0);
+		_pattern_at.assign(1, no_pattern);
+		_depths.assign(1, 0);
+		for (const auto& element : patterns)
+		{
+			const std::string_view pattern(element);
+			const auto index = static_cast<uint32_t>(_lengths.size());
+			_lengths.push_back(pattern.size());
+			if (pattern.empty()) { continue; }
+
+			uint32_t state = 0;
+			for (const char character : pattern)
+			{
+				const size_t cell = static_cast<size_t>(state) * _class_count + 
+									_classes[static_cast<unsigned char>(character)];
+				if (_transitions[cell] == 0)
+				{
+					const auto new_state = static_cast<uint32_t>(_pattern_at.size());
+					_transitions[cell] = new_state;
+					_transitions.resize(_transitions.size() + _class_count, 0);
+					_pattern_at.push_back(no_pattern);
+					_depths.push_back(_depths[state] + 1);
+				}
+				state = _transitions[cell];
+			}
+			if (_pattern_at[state] == no_pattern) { _pattern_at[state] = index; }
+		}
+
+		// visit the states in breadth first order so the failure state of every state is 
+		// complete before it is needed, missing transitions are replaced with the transitions
+		// of the failure state so the search never has to follow failure links
+		const size_t state_count = _pattern_at.size();
+		std::vector<uint32_t> failure(state_count, 0);
+		_match_state.assign(state_count, 0);
+		_output_link.assign(state_count, 0);
+		std::vector<uint32_t> queue;
+		queue.reserve(state_count);
+		queue.push_back(0);
+		for (size_t next = 0; next < queue.size(); ++next)
+		{
+			const uint32_t state = queue[next];
+			const size_t row = static_cast<size_t>(state) * _class_count;
+			const size_t failure_row = static_cast<size_t>(failure[state]) * _class_count;
+			for (size_t column = 0; column < _class_count; ++column)
+			{
+				const uint32_t child = _transitions[row + column];
+				if (child == 0)
+				{
+					_transitions[row + column] = (state == 0) ? 0 : 
+												 _transitions[failure_row + column];
+					continue;
+				}
+
+				const uint32_t child_failure = (state == 0) ? 0 : 
+											   _transitions[failure_row + column];
+				failure[child] = child_failure;
+				_output_link[child] = _match_state[child_failure];
+				_match_state[child] = (_pattern_at[child] != no_pattern) ? child : 
+																		   _output_link[child];
+				queue.push_back(child);
+			}
+		}
+
+		// store the position of the row of the next state in each transition and mark the
+		// transitions that lead to a state where a substring ends
+		if (state_count * _class_count > static_cast<size_t>(match_bit))
+		{
+			throw std::length_error("Too many substrings for mtl::string::multi_searcher.");
+		}
+		for (auto& transition : _transitions)
+		{
+			const uint32_t target = transition;
+			transition = static_cast<uint32_t>(target * _class_count);
+			if (_match_state[target] != 0) { transition |= match_bit; }
+		}
+	}
+
+public:
+
+	/// Default constructor that creates a searcher without any substrings.
+	multi_searcher() { build(std::vector<std::string_view>()); }
+
+	/// Constructor that creates a searcher for all the substrings of a container. The elements of
+	/// the container have to be convertible to std::string_view.
+	/// @param[in] patterns A container with the substrings to search for.
+	template<typename Container>
+	explicit multi_searcher(const Container& patterns) { build(patterns); }
+
+	/// Constructor that creates a searcher for all the substrings of a list.
+	/// @param[in] patterns A list with the substrings to search for.
+	multi_searcher(std::initializer_list<std::string_view> patterns) { build(patterns); }
+
+	/// Returns the number of substrings the searcher searches for.
+	/// @return The number of substrings.
+	[[nodiscard]]
+	size_t size() const noexcept { return _lengths.size(); }
+
+	/// Returns if any of the substrings is found inside the input string.
+	/// @param[in] value An std::string_view to search.
+	/// @return If any of the substrings was found.
+	[[nodiscard]]
+	bool contains(const std::string_view value) const noexcept
+	{
+		uint32_t row = 0;
+		for (const char character : value)
+		{
+			const uint32_t transition = next_transition(row, character);
+			if ((transition & match_bit) != 0) { return true; }
+			row = transition;
+		}
+		return false;
+	}
+
+	/// Finds the match that ends first. When more than one substring ends at the same position
+	/// the longest one is returned. Returns if any of the substrings was found.
+	/// @param[in] value An std::string_view to search.
+	/// @param[out] match An mtl::string::multi_match to store the match.
+	/// @return If any of the substrings was found.
+	bool find(const std::string_view value, multi_match& match) const noexcept
+	{
+		uint32_t row = 0;
+		for (size_t pos = 0; pos < value.size(); ++pos)
+		{
+			const uint32_t transition = next_transition(row, value[pos]);
+			row = transition & ~match_bit;
+			if ((transition & match_bit) != 0)
+			{
+				const uint32_t match_state = _match_state[transition_state(transition)];
+				match.pattern = _pattern_at[match_state];
+				match.length = _lengths[match.pattern];
+				match.position = pos + 1 - match.length;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/// Finds the match that starts first, beginning the search from a position. When more than
+	/// one substring starts at the same position the longest one is returned. Returns if any of
+	/// the substrings was found.
+	/// @param[in] value An std::string_view to search.
+	/// @param[out] match An mtl::string::multi_match to store the match.
+	/// @param[in] pos The position to start searching from.
+	/// @return If any of the substrings was found.
+	bool find_leftmost_longest(const std::string_view value, multi_match& match, 
+							   const size_t pos = 0) const noexcept
+	{
+		bool found = false;
+		uint32_t row = 0;
+		for (size_t current = pos; current < value.size(); ++current)
+		{
+			const uint32_t transition = next_transition(row, value[current]);
+			row = transition & ~match_bit;
+			if (((transition & match_bit) == 0) && (found == false)) { continue; }
+
+			const uint32_t state = transition_state(transition);
+			if ((transition & match_bit) != 0)
+			{
+				// the longest substring that ends here is the one that starts first and a match
+				// that ends later but starts at the same position or before is also longer
+				const size_t pattern = _pattern_at[_match_state[state]];
+				const size_t match_pos = current + 1 - _lengths[pattern];
+				if ((found == false) || (match_pos <= match.position))
+				{
+					match.pattern = pattern;
+					match.length = _lengths[pattern];
+					match.position = match_pos;
+					found = true;
+				}
+			}
+
+			// every match that ends later starts inside the characters of the current state, so
+			// when they start after the match no better match can be found
+			if (current + 1 - _depths[state] > match.position) { return true; }
+		}
+		return found;
+	}
+
+	/// Finds all the matches, including matches that overlap, and adds them to the container in
+	/// the order they end. Matches that end at the same position are added from the longest to
+	/// the shortest. Returns the number of matches found.
+	/// @param[in] value An std::string_view to search.
+	/// @param[out] matches A container of mtl::string::multi_match to add the matches.
+	/// @return The number of matches found.
+	template<typename Container>
+	size_t find_all(const std::string_view value, Container& matches) const
+	{
+		size_t count = 0;
+		uint32_t row = 0;
+		for (size_t pos = 0; pos < value.size(); ++pos)
+		{
+			const uint32_t transition = next_transition(row, value[pos]);
+			row = transition & ~match_bit;
+			if ((transition & match_bit) == 0) { continue; }
+
+			const uint32_t state = transition_state(transition);
+			for (uint32_t match_state = _match_state[state]; match_state != 0; 
+				 match_state = _output_link[match_state])
+			{
+				multi_match match;
+				match.pattern = _pattern_at[match_state];
+				match.length = _lengths[match.pattern];
+				match.position = pos + 1 - match.length;
+				mtl::emplace_back(matches, match);
+				++count;
+			}
+		}
+		return count;
+	}
+};
+
+
+
 // ===============================================================================================
 // STRIP_FRONT  - Strips all matching characters from the front.
 // STRIP_BACK   - Strips all matching characters from the back.
@@ -789,60 +1961,266 @@ inline std::string to_string(const std::pair<T1, T2>& value, const std::string&
 }
 
 
+/// Returns the maximum number of characters needed to convert a number of the given type to a
+/// string. For floating point numbers this includes all the digits needed to represent the number
+/// accurately, a sign, a decimal point and either an exponent or the leading zeros of a small
+/// number.
+/// @return The maximum number of characters for the type.
+template<typename Type>
+[[nodiscard]]
+constexpr size_t max_number_size() noexcept
+{
+	using numeric_limit = std::numeric_limits<Type>;
+	if constexpr (mtl::is_float_v<Type>)
+	{
+		size_t exponent_digits = 0;
+		for (auto exponent = numeric_limit::max_exponent10; exponent > 0; exponent /= 10)
+		{
+			++exponent_digits;
+		}
+		return static_cast<size_t>(numeric_limit::max_digits10) + 8 + exponent_digits;
+	}
+	else
+	{
+		// digits10 is one less than the maximum number of digits and the sign needs one more
+		const size_t sign_size = numeric_limit::is_signed ? 1 : 0;
+		return static_cast<size_t>(numeric_limit::digits10) + 1 + sign_size;
+	}
+}
+
+/// The maximum number of characters needed to convert a number of the given type to a string.
+/// Helper that allows you to elide the () at the end.
+template<typename Type>
+constexpr size_t max_number_size_v = max_number_size<Type>();
+
+namespace detail
+{
+
+// All the numbers from 00 to 99 one after the other, so two digits can be found at once.
+constexpr char digit_pairs[] =
+"00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+"40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+"8081828384858687888990919293949596979899";
+
+// Returns the number of digits of an unsigned integer.
+template<typename Unsigned>
+[[nodiscard]]
+inline int count_digits(Unsigned value) noexcept
+{
+	// check four digits at a time so there are fewer divisions
+	int digits = 1;
+	while (true)
+	{
+		if (value < 10U) { return digits; }
+		if (value < 100U) { return digits + 1; }
+		if (value < 1000U) { return digits + 2; }
+		if (value < 10000U) { return digits + 3; }
+		value /= 10000U;
+		digits += 4;
+	}
+}
+
+// Writes the digits of an unsigned integer backwards, two digits at a time, so the last digit is
+// right before the given end position.
+template<typename Unsigned>
+inline void write_digits(Unsigned value, char* end) noexcept
+{
+	while (value >= 100U)
+	{
+		const auto pair = static_cast<size_t>(value % 100U) * 2;
+		value /= 100U;
+		end -= 2;
+		end[0] = digit_pairs[pair];
+		end[1] = digit_pairs[pair + 1];
+	}
+
+	if (value >= 10U)
+	{
+		const auto pair = static_cast<size_t>(value) * 2;
+		end[-2] = digit_pairs[pair];
+		end[-1] = digit_pairs[pair + 1];
+	}
+	else
+	{
+		end[-1] = static_cast<char>('0' + value);
+	}
+}
+
+// Resizes a string without initializing the characters that are added, when the standard library
+// allows it, because they are going to be overwritten anyway.
+inline void resize_uninitialized(std::string& value, const size_t size)
+{
+#if defined(__cpp_lib_string_resize_and_overwrite)
+	// the size given to the function may be the new capacity with some standard libraries so
+	// always return the size that was asked for
+	value.resize_and_overwrite(size, [size](char*, size_t) { return size; });
+#else
+	value.resize(size);
+#endif // __cpp_lib_string_resize_and_overwrite end
+}
+
+} // namespace detail end
+
+/// Converts an integer to characters and writes them to a buffer without allocating. The digits
+/// are found two at a time using a table. The buffer has to have space for at least
+/// mtl::string::max_number_size_v characters of the integer's type. No null terminator is
+/// written.
+/// @param[in] value An integer to convert.
+/// @param[out] buffer The buffer where the characters will be written.
+/// @return A pointer to the position after the last written character.
+template<typename T>
+inline std::enable_if_t<mtl::is_int_v<T>, char*>
+to_string(const T& value, char* buffer) noexcept
+{
+	// small integers are converted as unsigned int to avoid integer promotions
+	using unsigned_type = std::conditional_t<(sizeof(T) <= sizeof(unsigned int)), unsigned int,
+											 std::make_unsigned_t<T>>;
+	auto number = static_cast<unsigned_type>(value);
+	if constexpr (std::is_signed_v<T>)
+	{
+		if (value < 0)
+		{
+			*buffer = '-';
+			++buffer;
+			number = static_cast<unsigned_type>(unsigned_type(0) - number);
+		}
+	}
+
+	const int digits = mtl::string::detail::count_digits(number);
+	buffer += digits;
+	mtl::string::detail::write_digits(number, buffer);
+	return buffer;
+}
+
+/// Converts a floating point number to characters and writes them to a buffer without allocating.
+/// The characters are exactly the same as mtl::string::to_string returns. The buffer has to have
+/// space for at least mtl::string::max_number_size_v characters of the floating point number's
+/// type. No null terminator is written.
+/// @param[in] value A floating point number to convert.
+/// @param[out] buffer The buffer where the characters will be written.
+/// @return A pointer to the position after the last written character.
+template<typename T>
+inline std::enable_if_t<mtl::is_float_v<T>, char*>
+to_string(const T& value, char* buffer)
+{
+	// when available use the format string compiled by fmt so it isn't parsed at runtime
+#if defined(FMT_COMPILE)
+	return fmt::format_to(buffer, FMT_COMPILE("{}"), value);
+#else
+	return fmt::format_to(buffer, "{}", value);
+#endif // FMT_COMPILE end
+}
+
+/// Converts an integer or a floating point number to characters and appends them to the end of an
+/// std::string. No temporary strings are created and allocates only if the std::string doesn't
+/// have enough capacity.
+/// @param[in] value A number to convert.
+/// @param[out] result The std::string where the characters will be appended.
+template<typename T>
+inline std::enable_if_t<mtl::is_number_v<T>, void>
+to_string(const T& value, std::string& result)
+{
+	// converting to a small buffer first and then appending is faster than resizing the
+	// std::string twice
+	char buffer[max_number_size_v<T>];
+	const char* last = mtl::string::to_string(value, buffer);
+	result.append(buffer, static_cast<size_t>(last - buffer));
+}
+
+
 // ===============================================================================================
 // JOIN_ALL - Join all items from a range (first, last) and return an std::string.
 // ===============================================================================================
 
+namespace detail
+{
+
+// Checks if the elements of a range are std::string or std::string_view, which can be joined by
+// copying their characters directly.
+template<typename Iter>
+constexpr bool is_joined_by_copy_v =
+std::is_same_v<std::remove_cv_t<typename std::iterator_traits<Iter>::value_type>, std::string> ||
+std::is_same_v<std::remove_cv_t<typename std::iterator_traits<Iter>::value_type>,
+			   std::string_view>;
+
+// Copies characters to the output and returns where the copied characters end.
+inline char* copy_characters(const std::string_view value, char* output) noexcept
+{
+	// std::memcpy doesn't allow a nullptr even when there is nothing to copy
+	if (value.empty() == false) { std::memcpy(output, value.data(), value.size()); }
+	return output + value.size();
+}
+
+// Returns the number of characters of the range from first to last joined with a delimiter.
+template<typename Iter>
+inline size_t joined_size(Iter first, Iter last, const std::string_view delimiter)
+{
+	size_t total_size = 0;
+	size_t count = 0;
+	for (auto it = first; it != last; ++it)
+	{
+		total_size += std::string_view(*it).size();
+		++count;
+	}
+	// there is a delimiter between every two elements
+	if (count > 0) { total_size += delimiter.size() * (count - 1); }
+	return total_size;
+}
+
+// Copies the range from first to last joined with a delimiter to the output, that has to have
+// enough space for all of them, and returns where the copied characters end.
+template<typename Iter>
+inline char* copy_joined(Iter first, Iter last, const std::string_view delimiter, char* output)
+{
+	if (first == last) { return output; } // GCOVR_EXCL_LINE
+
+	output = mtl::string::detail::copy_characters(std::string_view(*first), output);
+	++first;
+	if (delimiter.size() == 1)
+	{
+		for (; first != last; ++first)
+		{
+			*output = delimiter[0];
+			++output;
+			output = mtl::string::detail::copy_characters(std::string_view(*first), output);
+		}
+	}
+	else
+	{
+		for (; first != last; ++first)
+		{
+			output = mtl::string::detail::copy_characters(delimiter, output);
+			output = mtl::string::detail::copy_characters(std::string_view(*first), output);
+		}
+	}
+	return output;
+}
+
+} // namespace detail end
+
+
 /// Join all items of a range from first to last with a delimiter. Allows you to specify the 
-/// output string.
+/// output string. For elements of type std::string and std::string_view the size of the result is
+/// computed beforehand, so the output string is grown only once, and then all the characters are
+/// copied directly to it.
 /// @param[in] first Iterator to the start of the range.
 /// @param[in] last Iterator to the end of the range.
 /// @param[out] result Where the result will be placed.
 /// @param[in] delimiter Delimiter to use when joining the elements.
 template<typename Iter>
-inline std::enable_if_t
-<std::is_same_v<std::remove_cv_t<typename std::iterator_traits<Iter>::value_type>, std::string>,
-void>
+inline std::enable_if_t<mtl::string::detail::is_joined_by_copy_v<Iter>, void>
 join_all(Iter first, Iter last, std::string& result, const std::string& delimiter)
 {
 	// if there is nothing to join leave the function
 	if (first == last) { return; } // excluding live from gcovr code coverage, GCOVR_EXCL_LINE
 
-	// the size of the delimiter
-	const size_t delim_size = delimiter.size();
-
-	// count total size of all strings in the container plus the delimiter size
-	size_t total_size = 0;
-	for (auto it = first; it != last; ++it)
-	{
-		total_size += it->size() + delim_size;
-	}
-
-	result.reserve(total_size);
-
-	// join the string with a delimiter
-	if (delim_size > 0)
-	{
-		for (auto it = first; it != last; ++it)
-		{
-			// GCOVR_EXCL_START
-			result += *it;
-			result += delimiter;
-			// GCOVR_EXCL_STOP
-		}
+	// count total size of all strings in the container plus the size of the delimiters
+	const size_t total_size = mtl::string::detail::joined_size(first, last, delimiter);
 
-		// remove as many characters as the delimiter's size because we added one unwanted
-		// delimiter at the end
-		result.resize(result.size() - delimiter.size());
-	}
-	// join the string without adding the delimiter
-	else
-	{
-		for (auto it = first; it != last; ++it)
-		{
-			result += *it; // GCOVR_EXCL_LINE
-		}
-	}
+	// make space for all the characters at once and then copy them
+	const size_t original_size = result.size();
+	mtl::string::detail::resize_uninitialized(result, original_size + total_size);
+	mtl::string::detail::copy_joined(first, last, delimiter, result.data() + original_size);
 }
 
 
@@ -853,9 +2231,7 @@ join_all(Iter first, Iter last, std::string& result, const std::string& delimite
 /// @param[out] result Where the result will be placed.
 /// @param[in] delimiter Delimiter to use when joining the elements.
 template<typename Iter>
-inline std::enable_if_t
-<!std::is_same_v<std::remove_cv_t<typename std::iterator_traits<Iter>::value_type>, std::string>,
-void>
+inline std::enable_if_t<!mtl::string::detail::is_joined_by_copy_v<Iter>, void>
 join_all(Iter first, Iter last, std::string& result, const std::string& delimiter)
 {
 	// if there is nothing to join leave the function
@@ -961,6 +2337,119 @@ inline std::string join_all(Iter first, Iter last, const char* delimiter)
 	return mtl::string::join_all(first, last, mtl::string::to_string(delimiter));
 }
 
+/// Join all items of a range from first to last with a delimiter using multiple threads. Allows
+/// you to specify the output string. The elements have to be std::string or std::string_view and
+/// the iterators have to be random access iterators. The range is divided between the threads,
+/// each thread counts the size of its part, then the position where each part starts is found
+/// and finally every thread copies its part to its position of the output at the same time as
+/// the others. Small ranges are joined without threads. A thread_count of 0 uses as many threads
+/// as the hardware supports.
+/// @param[in] first Iterator to the start of the range.
+/// @param[in] last Iterator to the end of the range.
+/// @param[out] result Where the result will be placed.
+/// @param[in] delimiter Delimiter to use when joining the elements.
+/// @param[in] thread_count An optional number of threads to use.
+template<typename Iter>
+inline void join_all_parallel(Iter first, Iter last, std::string& result,
+							  const std::string_view delimiter, size_t thread_count = 0)
+{
+	static_assert(mtl::string::detail::is_joined_by_copy_v<Iter>,
+				  "The elements have to be std::string or std::string_view.");
+	static_assert(std::is_base_of_v<std::random_access_iterator_tag,
+				  typename std::iterator_traits<Iter>::iterator_category>,
+				  "The iterators have to be random access iterators.");
+
+	// if there is nothing to join leave the function
+	if (first == last) { return; } // GCOVR_EXCL_LINE
+
+	const auto count = static_cast<size_t>(std::distance(first, last));
+
+	// the smallest amount of elements worth giving to a thread
+	constexpr size_t min_chunk_elements = 16 * 1024;
+	if (thread_count == 0) { thread_count = std::thread::hardware_concurrency(); }
+	const size_t max_threads = count / min_chunk_elements;
+	if (thread_count > max_threads) { thread_count = max_threads; }
+
+	if (thread_count < 2)
+	{
+		mtl::string::join_all(first, last, result, std::string(delimiter));
+		return;
+	}
+
+	// the first element of each part with an extra element for the end of the last part
+	std::vector<Iter> parts;
+	parts.reserve(thread_count + 1);
+	for (size_t i = 0; i < thread_count; ++i)
+	{
+		parts.push_back(std::next(first, static_cast<std::ptrdiff_t>((count / thread_count) * i)));
+	}
+	parts.push_back(last);
+
+	// runs a function for every part, each one on its own thread
+	auto for_each_part = [&parts, thread_count](const auto& function)
+	{
+		std::vector<std::thread> threads;
+		threads.reserve(thread_count - 1);
+		size_t started = 1;
+		try
+		{
+			for (; started < thread_count; ++started) { threads.emplace_back(function, started); }
+		}
+		// GCOVR_EXCL_START
+		catch (const std::system_error&)
+		{
+			// the parts without a thread are done by the calling thread below
+		}
+		// GCOVR_EXCL_STOP
+		for (size_t i = started; i < thread_count; ++i) { function(i); }
+		function(size_t(0));
+		for (auto& thread : threads) { thread.join(); }
+	};
+
+	// count the size of each part, without the delimiter that comes before each part
+	std::vector<size_t> offsets(thread_count + 1, 0);
+	for_each_part([&parts, &offsets, delimiter](const size_t part)
+	{
+		offsets[part + 1] = mtl::string::detail::joined_size(parts[part], parts[part + 1],
+															 delimiter);
+	});
+
+	// find where each part starts, every part after the first starts with a delimiter
+	const size_t original_size = result.size();
+	offsets[0] = original_size;
+	for (size_t i = 1; i <= thread_count; ++i) { offsets[i] += offsets[i - 1]; }
+	for (size_t i = 2; i <= thread_count; ++i) { offsets[i] += delimiter.size() * (i - 1); }
+
+	mtl::string::detail::resize_uninitialized(result, offsets[thread_count]);
+	char* output = result.data();
+	for_each_part([&parts, &offsets, delimiter, output](const size_t part)
+	{
+		char* part_output = output + offsets[part];
+		if (part > 0)
+		{
+			part_output = mtl::string::detail::copy_characters(delimiter, part_output);
+		}
+		mtl::string::detail::copy_joined(parts[part], parts[part + 1], delimiter, part_output);
+	});
+}
+
+/// Join all items of a range from first to last with a delimiter using multiple threads. Allows
+/// you to specify the output string. The elements have to be std::string or std::string_view and
+/// the iterators have to be random access iterators. A thread_count of 0 uses as many threads as
+/// the hardware supports.
+/// @param[in] first Iterator to the start of the range.
+/// @param[in] last Iterator to the end of the range.
+/// @param[out] result Where the result will be placed.
+/// @param[in] delimiter Delimiter to use when joining the elements.
+/// @param[in] thread_count An optional number of threads to use.
+template<typename Iter>
+inline void join_all_parallel(Iter first, Iter last, std::string& result, const char delimiter,
+							  const size_t thread_count = 0)
+{
+	mtl::string::join_all_parallel(first, last, result, std::string_view(&delimiter, 1),
+								   thread_count);
+}
+
 
 
 
@@ -974,13 +2463,65 @@ inline std::string join_all(Iter first, Iter last, const char* delimiter)
 namespace detail 
 {
 
+// Actual implementation for variadic template join. Numbers are written directly to the end of
+// the string without creating any temporary strings.
+template<typename Type>
+inline std::enable_if_t<mtl::is_number_v<Type>, void>
+join_impl(std::string& value, const Type& type)
+{
+	mtl::string::to_string(type, value);
+}
+
 // Actual implementation for variadic template join.
 template<typename Type>
-inline void join_impl(std::string& value, const Type& type)
+inline std::enable_if_t<!mtl::is_number_v<Type>, void>
+join_impl(std::string& value, const Type& type)
 {
 	value += mtl::string::to_string(type); // GCOVR_EXCL_LINE
 }
 
+// Actual implementation for variadic template join for std::string.
+inline void join_impl(std::string& value, const std::string& type)
+{
+	value += type;
+}
+
+// Actual implementation for variadic template join for std::string_view.
+inline void join_impl(std::string& value, const std::string_view type)
+{
+	value += type;
+}
+
+// Actual implementation for variadic template join for const char*.
+inline void join_impl(std::string& value, const char* type)
+{
+	// if the const char* is nullptr throw because the conversion can't continue
+	if(type == nullptr)
+	{
+		throw std::logic_error("The const char* is nullptr."); // GCOVR_EXCL_LINE
+	}
+	value += type;
+}
+
+// Actual implementation for variadic template join for char.
+inline void join_impl(std::string& value, const char type)
+{
+	value.push_back(type);
+}
+
+// Actual implementation for variadic template join for bool.
+inline void join_impl(std::string& value, const bool type)
+{
+	if(type)
+	{
+		value += "true";
+	}
+	else
+	{
+		value += "false";
+	}
+}
+
 // Actual implementation for variadic template join.
 template<typename Type, typename... Args>
 inline void join_impl(std::string& value, const Type& type, Args&&... args)
@@ -995,6 +2536,12 @@ inline void count_size_impl(size_t& size, const std::string& type)
 	size += type.size();
 }
 
+// Count size for std::string_view.
+inline void count_size_impl(size_t& size, const std::string_view type)
+{
+	size += type.size();
+}
+
 // Count size for const char*.
 inline void count_size_impl(size_t& size, const char* type)
 {
@@ -1021,11 +2568,15 @@ inline void count_size_impl(size_t& size, const bool type)
 	
 }
 
-// Count size for int. This is intentionally empty and also declared so integer are not implicitly
-// converted to chars and to stop warnings about integer conversion.
-inline void count_size_impl(size_t&, const int)
+// Count size for integers and floating point numbers. The size is the maximum number of
+// characters the type can need, which is known at compile time, so numbers can be written
+// directly to the result without it ever growing. It is also declared so integers are not
+// implicitly converted to chars and to stop warnings about integer conversion.
+template<typename Type>
+inline std::enable_if_t<mtl::is_number_v<Type>, void>
+count_size_impl(size_t& size, const Type&)
 {
-
+	size += max_number_size_v<Type>;
 }
 
 // Count size for char.
@@ -1047,7 +2598,8 @@ inline void count_size_impl(size_t& size, const std::pair<Type1, Type2>& type)
 
 // Count size for all non-specialize types. Do not remove.
 template<typename Type>
-inline void count_size_impl(size_t&, const Type&)
+inline std::enable_if_t<!mtl::is_number_v<Type>, void>
+count_size_impl(size_t&, const Type&)
 {
 	// For non-specialized types the count is 0. All modern compilers with high optimization
 	// settings will turn this function into a NOOP.
@@ -1056,8 +2608,9 @@ inline void count_size_impl(size_t&, const Type&)
 
 
 
-// Variadic template that counts the number of characters for std::string, const char*, char and
-// std::pair found in the arguments. All other types are not counted.
+// Variadic template that counts the number of characters for std::string, std::string_view,
+// const char*, char, bool, numbers and std::pair found in the arguments. All other types are not
+// counted.
 template<typename Type, typename... Args>
 inline void count_size_impl(size_t& size, const Type& type, Args&&... args)
 {
@@ -1072,8 +2625,8 @@ template<typename Type, typename... Args>
 inline std::string join_select_impl(const Type& type, Args&&... args)
 {
 	size_t size = 0;
-	// count the number of characters of types that can be counted like std::string, const char* 
-	// and char so we can reserve the std::string's size
+	// count the number of characters of types that can be counted like std::string, const char*,
+	// char and numbers so we can reserve the std::string's size
 	count_size_impl(size, type, args...);
 
 	std::string result;
@@ -1244,6 +2797,527 @@ inline std::vector<std::string> split(const std::string& value, const char* deli
 
 
 
+// ================================================================================================
+// SPLIT_VIEW - Lazily splits a string into tokens with a given delimiter.
+// ================================================================================================
+
+/// A lazy view that splits a string into tokens with a delimiter. Tokens are std::string_view
+/// that point into the input and are found one at a time while iterating, so splitting never
+/// allocates any memory. Produces exactly the same tokens as mtl::string::split, an empty input
+/// has no tokens and an empty delimiter makes the whole input a single token. The input and the
+/// delimiter must outlive the mtl::string::split_view. Can be used in a range-based for loop.
+class split_view
+{
+	// The string to split.
+	std::string_view _value;
+	// The delimiter when it is a string.
+	std::string_view _delimiter;
+	// The delimiter when it is a single character.
+	char _character = '\0';
+	// If the delimiter is a single character.
+	bool _is_character = false;
+
+	// Returns the delimiter.
+	[[nodiscard]]
+	std::string_view delimiter() const noexcept
+	{
+		return _is_character ? std::string_view(&_character, 1) : _delimiter;
+	}
+
+	// Returns the position of the next delimiter at or after the given position or the size of
+	// the input if there are no more delimiters.
+	[[nodiscard]]
+	size_t next_delimiter(const size_t pos) const noexcept
+	{
+		size_t match_pos = std::string_view::npos;
+		if (_is_character) { match_pos = _value.find(_character, pos); }
+		else if (_delimiter.empty() == false) { match_pos = _value.find(_delimiter, pos); }
+		return (match_pos == std::string_view::npos) ? _value.size() : match_pos;
+	}
+
+public:
+
+	// ============================================================================================
+	// ITERATOR - Forward iterator over the tokens of an mtl::string::split_view.
+	// ============================================================================================
+
+	/// Forward iterator over the tokens of an mtl::string::split_view.
+	class iterator
+	{
+		// The view we iterate over.
+		const split_view* _view = nullptr;
+		// Position in the input where the current token starts, npos for the end iterator.
+		size_t _start = std::string_view::npos;
+		// Position in the input where the current token ends.
+		size_t _end = 0;
+		// The current token.
+		std::string_view _token;
+
+	public:
+
+		// some typedefs needed for proper iterator declaration
+
+		// The typedef for iterator type.
+		using value_type = std::string_view;
+		// The typedef for iterator difference.
+		using difference_type = std::ptrdiff_t;
+		// The typedef for iterator category.
+		using iterator_category = std::forward_iterator_tag;
+		// The typedef for iterator pointer type.
+		using pointer = const std::string_view*;
+		// The typedef for iterator reference type.
+		using reference = const std::string_view&;
+
+		// Constructor for the end iterator.
+		iterator() = default;
+
+		// Constructor that finds the first token.
+		explicit iterator(const split_view* view) : _view(view)
+		{
+			if (_view->_value.empty()) { return; }
+			_start = 0;
+			_end = _view->next_delimiter(0);
+			_token = _view->_value.substr(_start, _end - _start);
+		}
+
+		// Returns the current token.
+		[[nodiscard]]
+		reference operator*() const noexcept { return _token; }
+
+		// Returns a pointer to the current token.
+		[[nodiscard]]
+		pointer operator->() const noexcept { return &_token; }
+
+		// Pre increment operator that finds the next token.
+		iterator& operator++() noexcept
+		{
+			// the current token is the last one when it ends at the end of the input
+			if (_end == _view->_value.size())
+			{
+				_start = std::string_view::npos;
+				_end = 0;
+				_token = std::string_view();
+				return *this;
+			}
+			_start = _end + _view->delimiter().size();
+			_end = _view->next_delimiter(_start);
+			_token = _view->_value.substr(_start, _end - _start);
+			return *this;
+		}
+
+		// Post increment operator that finds the next token.
+		iterator operator++(int) noexcept
+		{
+			iterator previous = *this;
+			++(*this);
+			return previous;
+		}
+
+		// Equality operator.
+		[[nodiscard]]
+		bool operator==(const iterator& other) const noexcept 
+		{ 
+			return (_start == other._start) && (_end == other._end); 
+		}
+
+		// Difference operator.
+		[[nodiscard]]
+		bool operator!=(const iterator& other) const noexcept { return !(*this == other); }
+	};
+
+	/// Constructor that splits the input with a delimiter.
+	/// @param[in] value The string to split.
+	/// @param[in] delimiter A delimiter that will be used to identify where to split.
+	split_view(const std::string_view value, const std::string_view delimiter) noexcept
+	: _value(value), _delimiter(delimiter) {}
+
+	/// Constructor that splits the input with a delimiter.
+	/// @param[in] value The string to split.
+	/// @param[in] delimiter A delimiter that will be used to identify where to split.
+	split_view(const std::string_view value, const char delimiter) noexcept
+	: _value(value), _character(delimiter), _is_character(true) {}
+
+	/// Constructor that splits the input with a delimiter. Throws std::logic_error if the 
+	/// delimiter is nullptr, the same as mtl::string::split.
+	/// @param[in] value The string to split.
+	/// @param[in] delimiter A delimiter that will be used to identify where to split.
+	split_view(const std::string_view value, const char* delimiter) : _value(value)
+	{
+		if (delimiter == nullptr)
+		{
+			throw std::logic_error("The const char* is nullptr.");
+		}
+		_delimiter = std::string_view(delimiter);
+	}
+
+	/// Returns an iterator to the first token.
+	/// @return An iterator to the first token.
+	[[nodiscard]]
+	iterator begin() const noexcept { return iterator(this); }
+
+	/// Returns an iterator to the end.
+	/// @return An iterator to the end.
+	[[nodiscard]]
+	iterator end() const noexcept { return iterator(); }
+};
+
+
+
+
+
+// ================================================================================================
+// TOKEN_TABLE - The tokens of many strings stored in a single contiguous arena.
+// SPLIT_ALL   - Splits many strings into tokens with a given delimiter.
+// ================================================================================================
+
+/// The position of a token inside the arena of an mtl::string::token_table.
+struct token_span
+{
+	/// Position in the arena where the token starts.
+	size_t offset = 0;
+	/// The length of the token.
+	size_t length = 0;
+};
+
+class token_table;
+
+template<typename Container>
+inline void split_all(const Container& values, token_table& table,
+					  const std::string_view delimiter, size_t thread_count = 1);
+
+/// The tokens of many strings, called records, created by mtl::string::split_all. The characters
+/// of all the records are stored one after the other in a single arena and every token is a
+/// position and a length in the arena, so the whole table needs only a few allocations no matter
+/// how many records and tokens it has. Tokens stay valid as long as the table isn't modified and
+/// don't depend on the original strings.
+class token_table
+{
+	// The characters of all the records.
+	std::string _arena;
+	// The tokens of all the records in order.
+	std::vector<token_span> _tokens;
+	// For every record the index of its first token, with an extra element at the end so the
+	// tokens of a record are always from its element to the next element.
+	std::vector<size_t> _record_starts { 0 };
+
+	template<typename Container>
+	friend void split_all(const Container& values, token_table& table,
+						  const std::string_view delimiter, size_t thread_count);
+
+public:
+
+	/// Removes all the records and tokens but keeps the memory so the table can be reused.
+	void clear() noexcept
+	{
+		_arena.clear();
+		_tokens.clear();
+		_record_starts.resize(1);
+	}
+
+	/// Returns the number of records.
+	/// @return The number of records.
+	[[nodiscard]]
+	size_t size() const noexcept { return _record_starts.size() - 1; }
+
+	/// Returns if there are no records.
+	/// @return If there are no records.
+	[[nodiscard]]
+	bool empty() const noexcept { return (size() == 0); }
+
+	/// Returns the number of tokens of all the records.
+	/// @return The number of tokens.
+	[[nodiscard]]
+	size_t token_count() const noexcept { return _tokens.size(); }
+
+	/// Returns the number of tokens of a record. Throws std::out_of_range if the record is out of
+	/// range.
+	/// @param[in] record The index of the record.
+	/// @return The number of tokens of the record.
+	[[nodiscard]]
+	size_t token_count(const size_t record) const
+	{
+		if (record >= size())
+		{
+			throw std::out_of_range("The record index is out of range.");
+		}
+		return _record_starts[record + 1] - _record_starts[record];
+	}
+
+	/// Returns a token of a record. Throws std::out_of_range if the record or the token is out of
+	/// range.
+	/// @param[in] record The index of the record.
+	/// @param[in] index The index of the token in the record.
+	/// @return An std::string_view of the token.
+	[[nodiscard]]
+	std::string_view token(const size_t record, const size_t index) const
+	{
+		if (index >= token_count(record))
+		{
+			throw std::out_of_range("The token index is out of range.");
+		}
+		return view(_tokens[_record_starts[record] + index]);
+	}
+
+	/// Returns the tokens of all the records in order.
+	/// @return The positions of all the tokens in the arena.
+	[[nodiscard]]
+	const std::vector<token_span>& tokens() const noexcept { return _tokens; }
+
+	/// Returns the characters of a token.
+	/// @param[in] span The position of a token in the arena.
+	/// @return An std::string_view of the token.
+	[[nodiscard]]
+	std::string_view view(const token_span& span) const noexcept
+	{
+		return std::string_view(_arena.data() + span.offset, span.length);
+	}
+
+	/// Returns the characters of all the records one after the other.
+	/// @return An std::string_view of the arena.
+	[[nodiscard]]
+	std::string_view arena() const noexcept { return _arena; }
+};
+
+namespace detail
+{
+
+// Splits the records from first to last, not including last, with a single character delimiter
+// the same way mtl::string::split does and adds their tokens. All the records are scanned at once
+// so short records don't pay for starting a new scan. The bounds have the position in the arena
+// where each record starts with an extra element for the end of the last record. For each record
+// the number of tokens is stored to the counts.
+inline void split_records(const std::string_view arena, const std::vector<size_t>& bounds,
+						  const size_t first, const size_t last, const char delimiter,
+						  std::vector<token_span>& tokens, std::vector<size_t>& counts)
+{
+	const std::string_view chunk = arena.substr(bounds[first], bounds[last] - bounds[first]);
+
+	// counting the tokens beforehand costs a lot less than growing the tokens over and over again
+	size_t token_count = 0;
+	for (size_t record = first; record < last; ++record)
+	{
+		if (bounds[record + 1] > bounds[record]) { ++token_count; }
+	}
+	mtl::string::detail::find_all_chars(chunk, delimiter, [&token_count](size_t)
+	{
+		++token_count;
+	});
+	tokens.reserve(tokens.size() + token_count);
+
+	size_t record = first;
+	size_t token_start = bounds[first];
+	size_t record_tokens = tokens.size();
+
+	// adds the last token of the current record and moves to the next record
+	auto next_record = [&]()
+	{
+		if (bounds[record + 1] > bounds[record])
+		{
+			tokens.push_back(token_span { token_start, bounds[record + 1] - token_start });
+		}
+		counts[record] = tokens.size() - record_tokens;
+		++record;
+		token_start = bounds[record];
+		record_tokens = tokens.size();
+	};
+
+	mtl::string::detail::find_all_chars(chunk, delimiter, [&](const size_t chunk_pos)
+	{
+		const size_t match_pos = bounds[first] + chunk_pos;
+		while (match_pos >= bounds[record + 1]) { next_record(); }
+		tokens.push_back(token_span { token_start, match_pos - token_start });
+		token_start = match_pos + 1;
+	});
+
+	while (record < last) { next_record(); }
+}
+
+// Splits the records from first to last, not including last, the same way mtl::string::split
+// does and adds their tokens. The bounds have the position in the arena where each record starts
+// with an extra element for the end of the last record. For each record the number of tokens is
+// stored to the counts.
+inline void split_records(const std::string_view arena, const std::vector<size_t>& bounds,
+						  const size_t first, const size_t last,
+						  const std::string_view delimiter, const searcher& search,
+						  std::vector<token_span>& tokens, std::vector<size_t>& counts)
+{
+	if (delimiter.size() == 1)
+	{
+		mtl::string::detail::split_records(arena, bounds, first, last, delimiter[0], tokens,
+										   counts);
+		return;
+	}
+
+	for (size_t record = first; record < last; ++record)
+	{
+		const size_t start = bounds[record];
+		const std::string_view value = arena.substr(start, bounds[record + 1] - start);
+		const size_t original_size = tokens.size();
+
+		if (value.empty() == false)
+		{
+			size_t token_start = 0;
+			if (delimiter.empty() == false)
+			{
+				size_t match_pos = search.find(value);
+				while (match_pos != std::string_view::npos)
+				{
+					tokens.push_back(token_span { start + token_start, match_pos - token_start });
+					token_start = match_pos + delimiter.size();
+					match_pos = search.find(value, token_start);
+				}
+			}
+
+			// the last token is whatever is left after the last delimiter
+			tokens.push_back(token_span { start + token_start, value.size() - token_start });
+		}
+
+		counts[record] = tokens.size() - original_size;
+	}
+}
+
+} // namespace detail end
+
+
+/// Splits many strings into tokens with a delimiter and stores all of them to an
+/// mtl::string::token_table, replacing what the table had. Each string becomes a record of the
+/// table with exactly the same tokens mtl::string::split would produce. The strings are copied to
+/// a single arena and tokens are stored as positions in the arena so splitting doesn't allocate
+/// for every token. Delimiters are found with SSE2 or AVX2 when available. The elements of the
+/// container have to be convertible to std::string_view. The records can be divided between
+/// threads, a thread_count of 0 uses as many threads as the hardware supports.
+/// @param[in] values A container with the strings to split.
+/// @param[out] table An mtl::string::token_table where the tokens will be stored.
+/// @param[in] delimiter A delimiter that will be used to identify where to split.
+/// @param[in] thread_count An optional number of threads to use.
+template<typename Container>
+inline void split_all(const Container& values, token_table& table,
+					  const std::string_view delimiter, size_t thread_count)
+{
+	table.clear();
+
+	// copy all the strings to the arena and remember where each one starts
+	std::vector<size_t> bounds;
+	bounds.reserve(static_cast<size_t>(std::distance(std::begin(values), std::end(values))) + 1);
+	size_t total_size = 0;
+	for (const auto& element : values)
+	{
+		bounds.push_back(total_size);
+		total_size += std::string_view(element).size();
+	}
+	bounds.push_back(total_size);
+	table._arena.reserve(total_size);
+	for (const auto& element : values) { table._arena.append(std::string_view(element)); }
+
+	const size_t record_count = bounds.size() - 1;
+	const std::string_view arena = table._arena;
+	const mtl::string::searcher search(delimiter);
+	std::vector<size_t> counts(record_count, 0);
+
+	// the smallest amount of bytes worth giving to a thread
+	constexpr size_t min_chunk_size = 1024 * 1024;
+	if (thread_count == 0) { thread_count = std::thread::hardware_concurrency(); }
+	const size_t max_threads = total_size / min_chunk_size;
+	if (thread_count > max_threads) { thread_count = max_threads; }
+
+	if (thread_count < 2)
+	{
+		mtl::string::detail::split_records(arena, bounds, 0, record_count, delimiter, search,
+										   table._tokens, counts);
+	}
+	else
+	{
+		// divide the records so each thread gets about the same amount of bytes
+		std::vector<size_t> chunk_starts { 0 };
+		for (size_t i = 1; i < thread_count; ++i)
+		{
+			const auto bound = std::lower_bound(bounds.begin(), bounds.end() - 1,
+												(total_size / thread_count) * i);
+			const auto record = static_cast<size_t>(std::distance(bounds.begin(), bound));
+			if (record > chunk_starts.back()) { chunk_starts.push_back(record); }
+		}
+		chunk_starts.push_back(record_count);
+
+		const size_t chunk_count = chunk_starts.size() - 1;
+		std::vector<std::vector<token_span>> chunk_tokens(chunk_count);
+		std::vector<std::exception_ptr> errors(chunk_count);
+		const auto split_chunk = [&](const size_t i)
+		{
+			try
+			{
+				mtl::string::detail::split_records(arena, bounds, chunk_starts[i],
+												   chunk_starts[i + 1], delimiter, search,
+												   chunk_tokens[i], counts);
+			}
+			catch (...)
+			{
+				errors[i] = std::current_exception();
+			}
+		};
+
+		std::vector<std::thread> threads;
+		threads.reserve(chunk_count);
+		for (size_t i = 0; i < chunk_count; ++i)
+		{
+			// if the thread can't be started the chunk is split by the calling thread
+			try
+			{
+				threads.emplace_back(split_chunk, i);
+			}
+			// GCOVR_EXCL_START
+			catch (const std::system_error&)
+			{
+				split_chunk(i);
+			}
+			// GCOVR_EXCL_STOP
+		}
+
+		for (auto& thread : threads) { thread.join(); }
+
+		// if any of the threads failed rethrow the exception
+		for (const auto& error : errors)
+		{
+			if (error) { std::rethrow_exception(error); }
+		}
+
+		// add all the tokens to the table in order
+		size_t token_count = 0;
+		for (const auto& tokens : chunk_tokens) { token_count += tokens.size(); }
+		table._tokens.reserve(token_count);
+		for (const auto& tokens : chunk_tokens)
+		{
+			table._tokens.insert(table._tokens.end(), tokens.begin(), tokens.end());
+		}
+	}
+
+	// find where the tokens of each record start
+	table._record_starts.resize(record_count + 1);
+	for (size_t record = 0; record < record_count; ++record)
+	{
+		table._record_starts[record + 1] = table._record_starts[record] + counts[record];
+	}
+}
+
+/// Splits many strings into tokens with a delimiter and stores all of them to an
+/// mtl::string::token_table, replacing what the table had. Each string becomes a record of the
+/// table with exactly the same tokens mtl::string::split would produce. The elements of the
+/// container have to be convertible to std::string_view. The records can be divided between
+/// threads, a thread_count of 0 uses as many threads as the hardware supports.
+/// @param[in] values A container with the strings to split.
+/// @param[out] table An mtl::string::token_table where the tokens will be stored.
+/// @param[in] delimiter A delimiter that will be used to identify where to split.
+/// @param[in] thread_count An optional number of threads to use.
+template<typename Container>
+inline void split_all(const Container& values, token_table& table, const char delimiter,
+					  size_t thread_count = 1)
+{
+	mtl::string::split_all(values, table, std::string_view(&delimiter, 1), thread_count);
+}
+
+
+
+
+
 // ================================================================================================
 // REPLACE - Replaces all places in the input string where a match is found with 
 //           the replacement std::string / char* / char.
@@ -1600,5 +3674,63 @@ replace_all(std::string& value, const ContainerMatches& container_matches,
 }
 
 
+/// Replaces all places in the input where any of the substrings of an mtl::string::multi_searcher
+/// is found with the replacement at the same position in the replacements container. The input is
+/// read only once no matter how many substrings there are, and the output is built in a single
+/// buffer that is sized beforehand. Matches never overlap and when more than one substring
+/// matches the one that starts first is replaced, or the longest one if they start at the same
+/// position. Unlike the other mtl::string::replace_all the replacements are never searched for
+/// matches. If the number of substrings and replacements isn't the same it throws
+/// std::invalid_argument. The elements of the replacements container have to be convertible to
+/// std::string_view.
+/// @param[in, out] value An std::string to replace parts that match with a replacement.
+/// @param[in] matches An mtl::string::multi_searcher with the substrings to search for.
+/// @param[in] container_replacements A container with the replacements for the substrings.
+template<typename ContainerReplacements>
+inline void replace_all(std::string& value, const mtl::string::multi_searcher& matches, 
+						const ContainerReplacements& container_replacements)
+{
+	// check that there is a replacement for every substring
+	if(matches.size() != container_replacements.size())
+	{
+		throw std::invalid_argument(
+		"mtl::string::replace_all requires a replacement for every substring.");
+	}
+
+	// find all the matches and the size of the result
+	std::vector<multi_match> found;
+	mtl::string::multi_match match;
+	size_t result_size = value.size();
+	size_t pos = 0;
+	while (matches.find_leftmost_longest(value, match, pos))
+	{
+		found.push_back(match);
+		result_size -= match.length;
+		result_size += std::string_view(container_replacements[match.pattern]).size();
+		pos = match.position + match.length;
+	}
+
+	// if there are no matches there is nothing to replace
+	if(found.empty()) { return; }
+
+	// copy the parts between the matches and the replacements to the result
+	const std::string_view input = value;
+	std::string result;
+	mtl::string::detail::resize_uninitialized(result, result_size);
+	char* output = result.data();
+	size_t input_pos = 0;
+	for (const auto& replaced : found)
+	{
+		output = mtl::string::detail::copy_characters(
+				 input.substr(input_pos, replaced.position - input_pos), output);
+		output = mtl::string::detail::copy_characters(
+				 std::string_view(container_replacements[replaced.pattern]), output);
+		input_pos = replaced.position + replaced.length;
+	}
+	mtl::string::detail::copy_characters(input.substr(input_pos), output);
+
+	value.swap(result);
+}
+
 } // namespace string end
 } // namespace mtl end